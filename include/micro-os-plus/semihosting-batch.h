@@ -0,0 +1,214 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_BATCH_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_BATCH_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <micro-os-plus/semihosting.h>
+
+#include <cstddef>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BATCH_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BATCH_ARRAY_SIZE (16)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  /**
+   * @brief Multiple file operations, executed with a single trap.
+   *
+   * @details
+   * Requests for `SYS_OPEN`, `SYS_CLOSE`, `SYS_READ`, `SYS_WRITE` and
+   * `SYS_SEEK` are collected in an array, with the same parameters
+   * as the individual operations, and passed to the host with a
+   * single user defined operation, whose number is configured via
+   * `MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BATCH_OPERATION`.
+   *
+   * If this operation is not configured, or the host does not
+   * support it (it returns -1), the requests are replayed as
+   * individual calls, with the same results.
+   *
+   * The handle of a request can refer to the handle returned by an
+   * earlier `SYS_OPEN` in the same batch, via `result_of()`; this
+   * allows to open, read and close a file in a single trap.
+   *
+   * The host receives a parameter block with the address of the
+   * requests array and the number of requests, executes them in order,
+   * stores the result of each request, and the host errno if the
+   * result is negative, and returns the number of executed requests.
+   * A reference implementation is available in
+   * `scripts/semihosting-batch-host.c`.
+   */
+  class batch
+  {
+  public:
+    static constexpr std::size_t capacity
+        = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BATCH_ARRAY_SIZE;
+
+    /**
+     * @brief The layout of a request, as seen by the host; all fields
+     * have the size of a register.
+     */
+    struct request
+    {
+      param_block_t operation;
+      param_block_t block[3];
+      param_block_t result;
+      param_block_t error;
+    };
+
+    /**
+     * @brief A handle referring to the result of an earlier `SYS_OPEN`
+     * request in the same batch.
+     */
+    static constexpr int
+    result_of (std::size_t index) noexcept;
+
+    /**
+     * @brief Append a request, with the same arguments as `call<>()`.
+     * @return The request index, or `capacity` if the batch is full.
+     */
+    template <int Operation, typename... Args>
+    std::size_t
+    add (Args&&... args) noexcept;
+
+    /**
+     * @brief Execute all requests.
+     * @return 0 if all requests were successful, or the host error code
+     * of the first failed request.
+     */
+    int
+    run (void) noexcept;
+
+    /**
+     * @brief The result returned by the host, as for individual calls.
+     */
+    response_t
+    result (std::size_t index) const noexcept;
+
+    /**
+     * @brief The host error code if the result is negative, otherwise 0.
+     */
+    int
+    error (std::size_t index) const noexcept;
+
+    std::size_t
+    size (void) const noexcept;
+
+    /**
+     * @brief Remove all requests, to reuse the object.
+     */
+    void
+    clear (void) noexcept;
+
+  protected:
+    void
+    replay (std::size_t first) noexcept;
+
+  protected:
+    request requests_[capacity];
+    std::size_t size_ = 0;
+  };
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+// Inline definitions.
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  constexpr int
+  batch::result_of (std::size_t index) noexcept
+  {
+    // -1 remains an invalid handle.
+    return -2 - static_cast<int> (index);
+  }
+
+  template <int Operation, typename... Args>
+  std::size_t
+  batch::add (Args&&... args) noexcept
+  {
+    static_assert (Operation == SEMIHOSTING_SYS_OPEN
+                       || Operation == SEMIHOSTING_SYS_CLOSE
+                       || Operation == SEMIHOSTING_SYS_READ
+                       || Operation == SEMIHOSTING_SYS_WRITE
+                       || Operation == SEMIHOSTING_SYS_SEEK,
+                   "Operation not supported in a batch");
+    static_assert (detail::packed_in_block<Operation, Args...>,
+                   "Invalid arguments for this semihosting operation");
+
+    if (size_ == capacity)
+      {
+        return capacity;
+      }
+
+    request& r = requests_[size_];
+    r.operation = Operation;
+    operation<Operation>::pack (r.block, std::forward<Args> (args)...);
+    r.result = 0;
+    r.error = 0;
+
+    return size_++;
+  }
+
+  inline response_t
+  batch::result (std::size_t index) const noexcept
+  {
+    return static_cast<response_t> (requests_[index].result);
+  }
+
+  inline int
+  batch::error (std::size_t index) const noexcept
+  {
+    return static_cast<int> (requests_[index].error);
+  }
+
+  inline std::size_t
+  batch::size (void) const noexcept
+  {
+    return size_;
+  }
+
+  inline void
+  batch::clear (void) noexcept
+  {
+    size_ = 0;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_BATCH_H_
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,237 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_BLOCK_DEVICE_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_BLOCK_DEVICE_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <micro-os-plus/semihosting-file.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BLOCK_DEVICE_SECTOR_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BLOCK_DEVICE_SECTOR_SIZE (512)
+#endif
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BLOCK_DEVICE_CACHE_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BLOCK_DEVICE_CACHE_ARRAY_SIZE (8)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  /**
+   * @brief A block device backed by an image file on the host.
+   *
+   * @details
+   * The image is split in fixed size sectors, accessed via a small
+   * LRU cache, to be used as storage by target file systems
+   * (like FatFs or LittleFS) during tests.
+   *
+   * Writes are kept in the cache and written back only when a dirty
+   * sector must be evicted, or on `sync()`; at that moment, all dirty
+   * sectors are written, and adjacent ones are coalesced in a single
+   * `SYS_WRITE`. Reads of multiple sectors not in the cache are
+   * also done with a single `SYS_READ`, directly in the user buffer.
+   * The host file position is tracked, to skip unnecessary `SYS_SEEK`
+   * calls.
+   *
+   * The object includes the cache, thus it is quite large and should
+   * be statically allocated.
+   */
+  class block_device
+  {
+  public:
+    static constexpr std::size_t sector_size
+        = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BLOCK_DEVICE_SECTOR_SIZE;
+
+    static constexpr std::size_t cache_size
+        = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BLOCK_DEVICE_CACHE_ARRAY_SIZE;
+
+    /**
+     * @brief Counters, to evaluate the cache efficiency.
+     */
+    struct statistics
+    {
+      // Sectors found in the cache.
+      std::size_t hits;
+      // Sectors read from the host.
+      std::size_t misses;
+      // Host calls, including seeks.
+      std::size_t host_reads;
+      std::size_t host_writes;
+      std::size_t host_seeks;
+    };
+
+    block_device () noexcept = default;
+
+    block_device (const block_device&) = delete;
+
+    block_device&
+    operator= (const block_device&)
+        = delete;
+
+    /**
+     * @brief Write back the dirty sectors and close the image.
+     */
+    ~block_device () noexcept;
+
+    /**
+     * @brief Open an existing image file on the host.
+     * @return 0 if successful, or the host error code.
+     *
+     * @details
+     * The number of sectors is computed from the length of the file.
+     */
+    int
+    open (host_string path) noexcept;
+
+    /**
+     * @brief Write back the dirty sectors and close the image.
+     * @return 0 if successful, or the host error code.
+     */
+    int
+    close (void) noexcept;
+
+    /**
+     * @brief Read consecutive sectors.
+     * @return 0 if successful, or the error code.
+     */
+    int
+    read (std::size_t sector, void* buffer, std::size_t count) noexcept;
+
+    /**
+     * @brief Write consecutive sectors; the data is kept in the cache.
+     * @return 0 if successful, or the error code.
+     */
+    int
+    write (std::size_t sector, const void* buffer,
+           std::size_t count) noexcept;
+
+    /**
+     * @brief Write back all dirty sectors.
+     * @return 0 if successful, or the host error code.
+     */
+    int
+    sync (void) noexcept;
+
+    /**
+     * @brief The number of sectors in the image.
+     */
+    std::size_t
+    sectors (void) const noexcept;
+
+    const statistics&
+    stats (void) const noexcept;
+
+    void
+    clear_stats (void) noexcept;
+
+  protected:
+    static constexpr std::size_t unknown_position
+        = ~static_cast<std::size_t> (0);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    struct slot
+    {
+      std::size_t sector;
+      std::uint32_t last_used;
+      bool is_valid;
+      bool is_dirty;
+    };
+
+#pragma GCC diagnostic pop
+
+    std::size_t
+    find (std::size_t sector) noexcept;
+
+    int
+    allocate (std::size_t sector, std::size_t& index) noexcept;
+
+    void
+    swap_slots (std::size_t a, std::size_t b) noexcept;
+
+    int
+    seek (std::size_t sector) noexcept;
+
+    int
+    host_read (std::size_t sector, std::byte* buffer,
+               std::size_t count) noexcept;
+
+    int
+    host_write (std::size_t sector, const std::byte* buffer,
+                std::size_t count) noexcept;
+
+  protected:
+    file file_;
+    std::size_t sectors_ = 0;
+    // The host file position, in sectors, or `unknown_position`.
+    std::size_t position_ = unknown_position;
+    std::uint32_t tick_ = 0;
+    statistics stats_{};
+    slot slots_[cache_size]{};
+    std::byte data_[cache_size][sector_size];
+  };
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+// Inline definitions.
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  inline std::size_t
+  block_device::sectors (void) const noexcept
+  {
+    return sectors_;
+  }
+
+  inline const block_device::statistics&
+  block_device::stats (void) const noexcept
+  {
+    return stats_;
+  }
+
+  inline void
+  block_device::clear_stats (void) noexcept
+  {
+    stats_ = {};
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_BLOCK_DEVICE_H_
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,104 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_BOOT_PROFILER_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_BOOT_PROFILER_H_
+
+// ----------------------------------------------------------------------------
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif // defined(__cplusplus)
+
+  /**
+   * @brief Return a free running counter, used to timestamp the boot
+   * phases.
+   *
+   * @details
+   * The default (weak) definition uses the core cycle counter (DWT
+   * `CYCCNT` on Armv7-M/Armv8-M Mainline, `mcycle` on RISC-V, the
+   * generic timer on AArch64) or, if none is available, the host
+   * `SYS_ELAPSED` ticks. The application can redefine it to use
+   * another counter.
+   */
+  uint32_t
+  micro_os_plus_semihosting_boot_cycles (void);
+
+#if defined(__cplusplus)
+}
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <micro-os-plus/semihosting.h>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Boot phase timing.
+ *
+ * @details
+ * Each mark records the counter value, with a name for the phase
+ * which ends there; the first mark is the origin. The semihosting
+ * startup code marks the standard handles initialisation and the
+ * arguments processing; the application adds marks for its own phases
+ * (for example at the beginning of `main()`, after the static
+ * constructors).
+ *
+ * The counter is converted to time using the host `SYS_ELAPSED` and
+ * `SYS_TICKFREQ`, read around a short busy loop when reporting, since
+ * the counters of many cores stop while the core is halted for the
+ * traps; these are the only host calls, apart from the single one
+ * writing the report. For the same reason, the durations of the
+ * phases do not include the time spent in the host calls.
+ */
+namespace micro_os_plus::semihosting::boot_profiler
+{
+  // --------------------------------------------------------------------------
+
+  /**
+   * @brief Record the end of a boot phase.
+   * @param name The phase name; it must be a string literal, only the
+   * pointer is stored.
+   */
+  void
+  mark (const char* name) noexcept;
+
+  /**
+   * @brief Write the table of phases, with the counter difference
+   * and the duration in microseconds, in a single `SYS_WRITE0`.
+   *
+   * @details
+   * Called automatically on terminate, if not called before.
+   */
+  void
+  report (void) noexcept;
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::boot_profiler
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_BOOT_PROFILER_H_
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,190 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_COMPRESSED_WRITER_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_COMPRESSED_WRITER_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <micro-os-plus/semihosting-file.h>
+#include <micro-os-plus/semihosting-lz.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COMPRESSED_WRITER_BLOCK_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COMPRESSED_WRITER_BLOCK_SIZE (4096)
+#endif
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COMPRESSED_WRITER_HASH_BITS)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COMPRESSED_WRITER_HASH_BITS (10)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  /**
+   * @brief A writer which compresses the data before sending it
+   * to a host file, to use less of the slow debug link.
+   *
+   * @details
+   * The data is collected in blocks, each compressed with a small LZ77
+   * compressor (see `semihosting-lz.h`) and written to the host with a
+   * single `SYS_WRITE`; blocks which do not compress are stored as is.
+   *
+   * There is no heap; the object includes the buffers and the hash
+   * table, about twice the block size, and should be statically
+   * allocated.
+   *
+   * On the host, the file is decompressed with the
+   * `scripts/semihosting-lz-decompress.cpp` tool.
+   */
+  class compressed_writer
+  {
+  public:
+    static constexpr std::size_t block_size
+        = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COMPRESSED_WRITER_BLOCK_SIZE;
+
+    static constexpr unsigned int hash_bits
+        = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COMPRESSED_WRITER_HASH_BITS;
+
+    static_assert (block_size >= 16 && block_size <= lz::max_block_size,
+                   "The block size must be 16 to 65535");
+    static_assert (hash_bits >= 8 && hash_bits <= 16,
+                   "The hash must have 8 to 16 bits");
+
+    /**
+     * @brief Counters, to check the compression ratio.
+     */
+    struct statistics
+    {
+      std::size_t bytes_in;
+      // Including the headers.
+      std::size_t bytes_out;
+      // Host writes.
+      std::uint32_t host_writes;
+      // Blocks which did not compress.
+      std::uint32_t stored_blocks;
+    };
+
+    compressed_writer () noexcept = default;
+
+    compressed_writer (const compressed_writer&) = delete;
+
+    compressed_writer&
+    operator= (const compressed_writer&)
+        = delete;
+
+    /**
+     * @brief Write the buffered data and close the file.
+     */
+    ~compressed_writer () noexcept;
+
+    /**
+     * @brief Create the host file and write the stream header; if
+     * already open, it is closed first.
+     * @param path The host file.
+     * @return 0 if successful, or the host error code.
+     */
+    int
+    open (host_string path) noexcept;
+
+    /**
+     * @brief Write the buffered data and close the file.
+     * @return 0 if successful, or the host error code.
+     */
+    int
+    close (void) noexcept;
+
+    /**
+     * @brief Append data; each full block is compressed and
+     * written to the host.
+     * @return 0 if successful, or the host error code.
+     */
+    int
+    write (const void* data, std::size_t size) noexcept;
+
+    /**
+     * @brief Compress and write the data buffered so far, as a
+     * shorter block.
+     * @return 0 if successful, or the host error code.
+     *
+     * @details
+     * Short blocks compress less, call it only when the data must
+     * reach the host, for example before a breakpoint.
+     */
+    int
+    flush (void) noexcept;
+
+    bool
+    is_open (void) const noexcept;
+
+    statistics
+    stats (void) const noexcept;
+
+  protected:
+    int
+    write_block (void) noexcept;
+
+  protected:
+    file file_;
+    std::size_t used_ = 0;
+    statistics stats_{};
+    std::uint16_t table_[1u << hash_bits];
+    std::uint8_t input_[block_size];
+    std::uint8_t output_[lz::block_header_size + block_size];
+  };
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+// Inline definitions.
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  inline bool
+  compressed_writer::is_open (void) const noexcept
+  {
+    return file_.is_open ();
+  }
+
+  inline compressed_writer::statistics
+  compressed_writer::stats (void) const noexcept
+  {
+    return stats_;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_COMPRESSED_WRITER_H_
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,142 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_COPY_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_COPY_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <micro-os-plus/semihosting-file.h>
+
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COPY_BUFFER_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COPY_BUFFER_ARRAY_SIZE (256)
+#endif
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COPY_COMMAND_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COPY_COMMAND_ARRAY_SIZE (256)
+#endif
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Copy host files on the host, without moving the data through
+ * the target.
+ *
+ * @details
+ * The copy is passed to the host with a single user defined
+ * operation, whose number is configured via
+ * `MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COPY_OPERATION`. If this operation
+ * is not configured, or the host does not support it, whole files
+ * can be copied with a shell command, via `SYS_SYSTEM`, when
+ * `MICRO_OS_PLUS_USE_SEMIHOSTING_COPY_SYSTEM` is defined.
+ * Otherwise the data is read into a buffer on the stack and written
+ * back, in chunks.
+ *
+ * The parameter block of the host operation has six fields; the first
+ * one selects the form:
+ * - 0, whole file: the address and the length of the source path,
+ *   the address and the length of the destination path, and 1 to
+ *   append to the destination, or 0 to replace it;
+ * - 1, range: the source handle and offset, the destination handle
+ *   and offset, and the number of bytes.
+ *
+ * The host returns the number of bytes copied, or -1 and sets the
+ * error returned by `SYS_ERRNO`; `ENOSYS` means that the form is not
+ * supported. A reference implementation is available in
+ * `scripts/semihosting-copy-host.c`.
+ */
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  /**
+   * @brief How the last copy was performed.
+   */
+  enum class copy_method : int
+  {
+    host_operation = 0,
+    system = 1,
+    target = 2
+  };
+
+  /**
+   * @brief The result of a copy.
+   *
+   * @details
+   * If `error` is 0 the copy was successful; `count` is the number of
+   * bytes copied, except for `copy_method::system`, which does not
+   * report it, and leaves it 0.
+   */
+  struct copy_result
+  {
+    std::size_t count;
+    int error;
+    copy_method method;
+
+    constexpr explicit
+    operator bool (void) const noexcept;
+  };
+
+  /**
+   * @brief Copy a host file to another host file, replacing it,
+   * or appending to it.
+   */
+  copy_result
+  copy_file (host_string from, host_string to, bool append = false) noexcept;
+
+  /**
+   * @brief Copy a range of bytes between two open host files.
+   *
+   * @details
+   * The copy stops early at the end of the source file. The current
+   * positions of both files are not defined after the call; use
+   * `seek()` before the next `read()` or `write()`.
+   */
+  copy_result
+  copy_file_range (file& from, std::size_t from_offset, file& to,
+                   std::size_t to_offset, std::size_t size) noexcept;
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+// Inline definitions.
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  constexpr copy_result::operator bool (void) const noexcept
+  {
+    return error == 0;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_COPY_H_
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,236 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_DATA_LOGGER_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_DATA_LOGGER_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <micro-os-plus/semihosting-file.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_DATA_LOGGER_BUFFER_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_DATA_LOGGER_BUFFER_SIZE (2048)
+#endif
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_DATA_LOGGER_BUFFERS_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_DATA_LOGGER_BUFFERS_ARRAY_SIZE (2)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  /**
+   * @brief A logger of fixed size binary records to a host file,
+   * to be filled from interrupts.
+   *
+   * @details
+   * The records are stored in a ring of buffers; `log()` only copies
+   * the record in the current buffer, reserving the place with a
+   * compare-and-swap, so it can be called from any interrupt, at any
+   * priority, without locks and without host calls.
+   *
+   * A thread calls `drain()` periodically, to write each full buffer
+   * to the host with a single `SYS_WRITE`. When all buffers are full,
+   * the new records are dropped and counted as overruns; `log()` never
+   * waits.
+   *
+   * The file has no header, only the records, back to back, in the
+   * target byte order.
+   *
+   * The object includes the buffers, thus it is quite large and should
+   * be statically allocated.
+   */
+  class data_logger
+  {
+  public:
+    static constexpr std::size_t buffer_size
+        = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_DATA_LOGGER_BUFFER_SIZE;
+
+    static constexpr std::size_t buffers
+        = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_DATA_LOGGER_BUFFERS_ARRAY_SIZE;
+
+    static_assert (buffers >= 2 && buffers <= 0xFFFF,
+                   "The data logger needs at least 2 buffers");
+
+    /**
+     * @brief Counters, to check the logger keeps up with the data.
+     */
+    struct statistics
+    {
+      // Records dropped because all buffers were full.
+      std::uint32_t overruns;
+      // Host writes.
+      std::uint32_t host_writes;
+      std::size_t bytes_written;
+    };
+
+    data_logger () noexcept = default;
+
+    data_logger (const data_logger&) = delete;
+
+    data_logger&
+    operator= (const data_logger&)
+        = delete;
+
+    /**
+     * @brief Write the logged records and close the file.
+     */
+    ~data_logger () noexcept;
+
+    /**
+     * @brief Create the host file; if already open, it is closed first.
+     * @param path The host file.
+     * @param record_size The size of each record, in bytes; at most
+     * `buffer_size`.
+     * @return 0 if successful, or the host error code.
+     *
+     * @details
+     * Must be called before enabling the interrupts which log records.
+     */
+    int
+    open (host_string path, std::size_t record_size) noexcept;
+
+    /**
+     * @brief Write the logged records, including those in the current
+     * buffer, and close the file.
+     * @return 0 if successful, or the host error code.
+     *
+     * @details
+     * Must be called after disabling the interrupts which log records.
+     */
+    int
+    close (void) noexcept;
+
+    /**
+     * @brief Copy a record in the current buffer.
+     * @param record Pointer to `record_size` bytes.
+     * @retval true The record was stored.
+     * @retval false All buffers are full, or the logger is not open;
+     * the record was counted as an overrun.
+     *
+     * @details
+     * Lock-free and without host calls; it can be called from
+     * interrupts, concurrently with `drain()`.
+     */
+    bool
+    log (const void* record) noexcept;
+
+    /**
+     * @brief Write all full buffers to the host, one `SYS_WRITE`
+     * per buffer.
+     * @return 0 if successful, or the host error code.
+     *
+     * @details
+     * To be called from a single thread; it is not re-entrant.
+     * If a write fails, the buffer is kept, and written again
+     * on the next call.
+     */
+    int
+    drain (void) noexcept;
+
+    bool
+    is_open (void) const noexcept;
+
+    std::size_t
+    record_size (void) const noexcept;
+
+    /**
+     * @brief The number of records in each buffer.
+     */
+    std::size_t
+    records_per_buffer (void) const noexcept;
+
+    statistics
+    stats (void) const noexcept;
+
+    void
+    clear_stats (void) noexcept;
+
+  protected:
+    int
+    write_buffer (std::size_t index, std::size_t count) noexcept;
+
+  protected:
+    file file_;
+    std::size_t record_size_ = 0;
+    std::uint32_t capacity_ = 0;
+    // The buffer being filled, in the high half, and the number of
+    // records reserved in it, in the low half; updated only with
+    // compare-and-swap.
+    std::uint32_t head_ = 0;
+    // The next buffer to be written; used only by `drain()`.
+    std::uint32_t tail_ = 0;
+    // The number of records copied in each buffer; a buffer is full
+    // when equal to `capacity_`.
+    std::uint32_t committed_[buffers]{};
+    // Set by `drain()` when the buffer was written to the host, and
+    // cleared by the producer which switches to it.
+    std::uint32_t released_[buffers]{};
+    std::uint32_t overruns_ = 0;
+    std::uint32_t host_writes_ = 0;
+    std::size_t bytes_written_ = 0;
+    alignas (8) std::byte data_[buffers][buffer_size];
+  };
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+// Inline definitions.
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  inline bool
+  data_logger::is_open (void) const noexcept
+  {
+    return file_.is_open ();
+  }
+
+  inline std::size_t
+  data_logger::record_size (void) const noexcept
+  {
+    return record_size_;
+  }
+
+  inline std::size_t
+  data_logger::records_per_buffer (void) const noexcept
+  {
+    return capacity_;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_DATA_LOGGER_H_
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,177 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_FILE_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_FILE_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <micro-os-plus/semihosting.h>
+
+#include <cstddef>
+#include <span>
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  /**
+   * @brief A file on the host, accessed directly via semihosting.
+   *
+   * @details
+   * The object owns the host handle and closes it when destroyed;
+   * it can be moved, but not copied.
+   *
+   * There is no buffering, the buffers passed to `read()` and
+   * `write()` go directly to the host, and `errno` is not changed;
+   * errors are returned as host error codes, as obtained via
+   * `SYS_ERRNO`.
+   */
+  class file
+  {
+  public:
+    /**
+     * @brief The result of an operation returning a count.
+     *
+     * @details
+     * If `error` is 0 the operation was successful and `count` is valid,
+     * otherwise `error` is the host error code.
+     */
+    struct result
+    {
+      std::size_t count;
+      int error;
+
+      constexpr explicit
+      operator bool (void) const noexcept;
+    };
+
+    file () noexcept = default;
+
+    file (const file&) = delete;
+
+    file&
+    operator= (const file&)
+        = delete;
+
+    file (file&& other) noexcept;
+
+    file&
+    operator= (file&& other) noexcept;
+
+    ~file () noexcept;
+
+    /**
+     * @brief Open a host file; if already open, it is closed first.
+     * @return 0 if successful, or the host error code.
+     */
+    int
+    open (host_string path, open_mode mode) noexcept;
+
+    /**
+     * @brief Close the host file.
+     * @return 0 if successful, or the host error code.
+     */
+    int
+    close (void) noexcept;
+
+    /**
+     * @brief Read from the current position.
+     * @return The number of bytes read; 0 at end of file.
+     */
+    result
+    read (std::span<std::byte> buffer) noexcept;
+
+    /**
+     * @brief Write at the current position.
+     * @return The number of bytes written.
+     */
+    result
+    write (std::span<const std::byte> buffer) noexcept;
+
+    /**
+     * @brief Move the current position, counted from the beginning
+     * of the file.
+     * @return 0 if successful, or the host error code.
+     */
+    int
+    seek (std::size_t position) noexcept;
+
+    /**
+     * @brief Get the length of the file.
+     */
+    result
+    size (void) noexcept;
+
+    bool
+    is_open (void) const noexcept;
+
+    /**
+     * @brief The handle used by the host, or -1 if not open.
+     */
+    int
+    native_handle (void) const noexcept;
+
+  protected:
+    int handle_ = -1;
+  };
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+// Inline definitions.
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  constexpr file::result::operator bool (void) const noexcept
+  {
+    return error == 0;
+  }
+
+  inline file::file (file&& other) noexcept : handle_{ other.handle_ }
+  {
+    other.handle_ = -1;
+  }
+
+  inline bool
+  file::is_open (void) const noexcept
+  {
+    return handle_ != -1;
+  }
+
+  inline int
+  file::native_handle (void) const noexcept
+  {
+    return handle_;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_FILE_H_
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,81 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_GCOV_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_GCOV_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <micro-os-plus/semihosting.h>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Bulk coverage dump.
+ *
+ * @details
+ * Instead of creating each `.gcda` file on the host, with one
+ * open/write/close sequence per object file, all the gcov records
+ * are serialised in a single stream, written to one host file
+ * in large chunks.
+ *
+ * The application must be compiled with `--coverage
+ * -fprofile-info-section`, and the linker script must collect the
+ * `.gcov_info` sections:
+ *
+ * @code{.unparsed}
+ * .gcov_info :
+ * {
+ *   PROVIDE (__gcov_info_start = .);
+ *   KEEP (*(.gcov_info))
+ *   PROVIDE (__gcov_info_end = .);
+ * } > FLASH
+ * @endcode
+ *
+ * On the host, `scripts/split-gcov-stream.py` recreates the individual
+ * `.gcda` files from the stream.
+ *
+ * Stream format, all lengths are 32-bit little endian:
+ * - the "SHGC" magic and a version word (1)
+ * - records with a type byte, a length and the payload, where the
+ * type is 'F' for a file name and 'D' for data to be appended to the
+ * last named file.
+ */
+namespace micro_os_plus::semihosting::gcov
+{
+  // --------------------------------------------------------------------------
+
+  /**
+   * @brief Serialise all gcov records to a single host file.
+   * @return 0 if successful, the host error code, or `ENAMETOOLONG`
+   * if the name of an object did not fit the buffer; such objects
+   * are skipped, the others are still written.
+   */
+  int
+  dump (host_string path);
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::gcov
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_GCOV_H_
+
+// ----------------------------------------------------------------------------
@@ -23,6 +23,13 @@
 // include `call_host()`.
 #include <micro-os-plus/architecture.h>
 
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+
 // ----------------------------------------------------------------------------
 
 namespace micro_os_plus::semihosting
@@ -30,10 +37,517 @@ namespace micro_os_plus::semihosting
   // --------------------------------------------------------------------------
   // Portable semihosting functions in C++.
 
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_DETACHED_MODE)
+
+  namespace detail
+  {
+    enum class host_state : std::uint8_t
+    {
+      unknown = 0,
+      attached,
+      detached
+    };
+
+    extern host_state state;
+
+    // Probe the host if needed, and return the result when detached.
+    response_t
+    call_host_not_attached (int reason, param_block_t* arg);
+  } // namespace detail
+
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_DETACHED_MODE)
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_MAILBOX)
+
+  namespace detail
+  {
+    inline __attribute__ ((always_inline)) bool
+    is_mailbox_polled (void)
+    {
+      return std::atomic_ref<std::uint32_t> (
+                 micro_os_plus_semihosting_mailbox.host_flags)
+                 .load (std::memory_order_relaxed)
+             & MICRO_OS_PLUS_SEMIHOSTING_MAILBOX_HOST_POLLING;
+    }
+
+    // Pass the request via the mailbox, without trapping.
+    response_t
+    call_host_mailbox (int reason, param_block_t* arg);
+  } // namespace detail
+
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_MAILBOX)
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SMP)
+
+  namespace detail
+  {
+    // Trap, serialised with the other cores.
+    response_t
+    call_host_smp (int reason, param_block_t* arg);
+  } // namespace detail
+
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SMP)
+
+  namespace detail
+  {
+    // The trap, possibly serialised or shortcut when detached.
+    inline __attribute__ ((always_inline)) response_t
+    call_host_trap (int reason, param_block_t* arg)
+    {
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_DETACHED_MODE)
+      if (state != host_state::attached) [[unlikely]]
+        {
+          return call_host_not_attached (reason, arg);
+        }
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_DETACHED_MODE)
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SMP)
+      return call_host_smp (reason, arg);
+#else
+      return micro_os_plus_semihosting_call_host (reason, arg);
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SMP)
+    }
+  } // namespace detail
+
   inline __attribute__ ((always_inline)) response_t
   call_host (int reason, param_block_t* arg)
   {
-    return micro_os_plus_semihosting_call_host (reason, arg);
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_MAILBOX)
+    // Open and close pass via the mailbox code also when they trap,
+    // to learn the console handles opened before the host polls;
+    // errno, to report the requests lost when the host stopped polling.
+    if (detail::is_mailbox_polled () || reason == SEMIHOSTING_SYS_OPEN
+        || reason == SEMIHOSTING_SYS_CLOSE || reason == SEMIHOSTING_SYS_ERRNO)
+      {
+        return detail::call_host_mailbox (reason, arg);
+      }
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_MAILBOX)
+
+    return detail::call_host_trap (reason, arg);
+  }
+
+  // --------------------------------------------------------------------------
+
+  constexpr __attribute__ ((always_inline))
+  host_string::host_string (const char* str) noexcept
+      : data_{ str }, length_{ unknown_length }
+  {
+    // At run time the length is computed late, in `length()`, after the
+    // pointer is stored in the parameter block, which saves a register.
+    if (std::is_constant_evaluated ())
+      {
+        length_ = std::char_traits<char>::length (str);
+      }
+  }
+
+  constexpr __attribute__ ((always_inline))
+  host_string::host_string (const char* str, std::size_t length) noexcept
+      : data_{ str }, length_{ length }
+  {
+  }
+
+  constexpr __attribute__ ((always_inline)) const char*
+  host_string::data (void) const noexcept
+  {
+    return data_;
+  }
+
+  constexpr __attribute__ ((always_inline)) std::size_t
+  host_string::length (void) const noexcept
+  {
+    if (length_ != unknown_length)
+      {
+        return length_;
+      }
+    return std::char_traits<char>::length (data_);
+  }
+
+  /**
+   * @brief The special file name used for the host console.
+   */
+  inline constexpr host_string console_path{ ":tt" };
+
+  // --------------------------------------------------------------------------
+
+  namespace detail
+  {
+    // Pointers are passed to the host as register sized integers.
+    inline __attribute__ ((always_inline)) param_block_t
+    to_field (const void* ptr)
+    {
+      return reinterpret_cast<param_block_t> (ptr);
+    }
+
+    // Pointers passed directly in the parameter register.
+    // The cast through void* is necessary to silence
+    // an alignment warning.
+    inline __attribute__ ((always_inline)) param_block_t*
+    to_register (const void* ptr)
+    {
+      return static_cast<param_block_t*> (const_cast<void*> (ptr));
+    }
+
+    template <int Operation, typename... Args>
+    concept packed_in_block = (operation<Operation>::block_size > 0)
+                              && requires (param_block_t* block,
+                                           Args&&... args) {
+                                   operation<Operation>::pack (
+                                       block, std::forward<Args> (args)...);
+                                 };
+
+    template <int Operation, typename... Args>
+    concept passed_in_register
+        = (operation<Operation>::block_size == 0)
+          && requires (Args&&... args) {
+               {
+                 operation<Operation>::argument (
+                     std::forward<Args> (args)...)
+                 } -> std::same_as<param_block_t*>;
+             };
+  } // namespace detail
+
+  // --------------------------------------------------------------------------
+  // Operations without parameters.
+
+  template <int Operation>
+  struct no_parameters_operation
+  {
+    static constexpr std::size_t block_size = 0;
+
+    static inline __attribute__ ((always_inline)) param_block_t*
+    argument (void)
+    {
+      return nullptr;
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_CLOCK>
+      : no_parameters_operation<SEMIHOSTING_SYS_CLOCK>
+  {
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_ERRNO>
+      : no_parameters_operation<SEMIHOSTING_SYS_ERRNO>
+  {
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_READC>
+      : no_parameters_operation<SEMIHOSTING_SYS_READC>
+  {
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_TICKFREQ>
+      : no_parameters_operation<SEMIHOSTING_SYS_TICKFREQ>
+  {
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_TIME>
+      : no_parameters_operation<SEMIHOSTING_SYS_TIME>
+  {
+  };
+
+  // --------------------------------------------------------------------------
+  // Operations with a pointer passed directly in the parameter register.
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_WRITEC>
+  {
+    static constexpr std::size_t block_size = 0;
+
+    static inline __attribute__ ((always_inline)) param_block_t*
+    argument (const char* ch)
+    {
+      return detail::to_register (ch);
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_WRITE0>
+  {
+    static constexpr std::size_t block_size = 0;
+
+    static inline __attribute__ ((always_inline)) param_block_t*
+    argument (const char* str)
+    {
+      return detail::to_register (str);
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_HEAPINFO>
+  {
+    static constexpr std::size_t block_size = 0;
+
+    // The host fills in a block of 4 fields.
+    static inline __attribute__ ((always_inline)) param_block_t*
+    argument (param_block_t (&block)[4])
+    {
+      return block;
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_ELAPSED>
+  {
+    static constexpr std::size_t block_size = 0;
+
+    // The host fills in a 64-bit tick count.
+    static inline __attribute__ ((always_inline)) param_block_t*
+    argument (std::uint64_t* ticks)
+    {
+      return detail::to_register (ticks);
+    }
+  };
+
+  // --------------------------------------------------------------------------
+  // Operations with a parameter block.
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_OPEN>
+  {
+    static constexpr std::size_t block_size = 3;
+
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, host_string path, open_mode mode)
+    {
+      block[0] = detail::to_field (path.data ());
+      block[1] = static_cast<param_block_t> (mode);
+      block[2] = path.length ();
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_CLOSE>
+  {
+    static constexpr std::size_t block_size = 1;
+
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, int handle)
+    {
+      block[0] = static_cast<param_block_t> (handle);
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_FLEN>
+  {
+    static constexpr std::size_t block_size = 1;
+
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, int handle)
+    {
+      block[0] = static_cast<param_block_t> (handle);
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_ISTTY>
+  {
+    static constexpr std::size_t block_size = 1;
+
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, int handle)
+    {
+      block[0] = static_cast<param_block_t> (handle);
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_ISERROR>
+  {
+    static constexpr std::size_t block_size = 1;
+
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, response_t status)
+    {
+      block[0] = static_cast<param_block_t> (status);
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_READ>
+  {
+    static constexpr std::size_t block_size = 3;
+
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, int handle, void* buf, std::size_t nbyte)
+    {
+      block[0] = static_cast<param_block_t> (handle);
+      block[1] = detail::to_field (buf);
+      block[2] = nbyte;
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_WRITE>
+  {
+    static constexpr std::size_t block_size = 3;
+
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, int handle, const void* buf,
+          std::size_t nbyte)
+    {
+      block[0] = static_cast<param_block_t> (handle);
+      block[1] = detail::to_field (buf);
+      block[2] = nbyte;
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_SEEK>
+  {
+    static constexpr std::size_t block_size = 2;
+
+    // Only absolute positions.
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, int handle, param_block_t position)
+    {
+      block[0] = static_cast<param_block_t> (handle);
+      block[1] = position;
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_GETCMDLINE>
+  {
+    static constexpr std::size_t block_size = 2;
+
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, char* buf, std::size_t size)
+    {
+      block[0] = detail::to_field (buf);
+      block[1] = size;
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_TMPNAM>
+  {
+    static constexpr std::size_t block_size = 3;
+
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, char* buf, int id, std::size_t size)
+    {
+      block[0] = detail::to_field (buf);
+      block[1] = static_cast<param_block_t> (id);
+      block[2] = size;
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_REMOVE>
+  {
+    static constexpr std::size_t block_size = 2;
+
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, host_string path)
+    {
+      block[0] = detail::to_field (path.data ());
+      block[1] = path.length ();
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_SYSTEM>
+  {
+    static constexpr std::size_t block_size = 2;
+
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, host_string command)
+    {
+      block[0] = detail::to_field (command.data ());
+      block[1] = command.length ();
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_RENAME>
+  {
+    static constexpr std::size_t block_size = 4;
+
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, host_string existing, host_string _new)
+    {
+      block[0] = detail::to_field (existing.data ());
+      block[1] = existing.length ();
+      block[2] = detail::to_field (_new.data ());
+      block[3] = _new.length ();
+    }
+  };
+
+  template <>
+  struct operation<SEMIHOSTING_SYS_EXIT_EXTENDED>
+  {
+    static constexpr std::size_t block_size = 2;
+
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, param_block_t reason, int code)
+    {
+      block[0] = reason;
+      block[1] = static_cast<param_block_t> (code);
+    }
+  };
+
+#if (__SIZEOF_POINTER__ == 4)
+
+  // On 32-bits the reason is passed directly, and the exit code
+  // cannot be passed; use SYS_EXIT_EXTENDED if needed.
+  template <>
+  struct operation<SEMIHOSTING_SYS_EXIT>
+  {
+    static constexpr std::size_t block_size = 0;
+
+    static inline __attribute__ ((always_inline)) param_block_t*
+    argument (param_block_t reason, [[maybe_unused]] int code)
+    {
+      return reinterpret_cast<param_block_t*> (reason);
+    }
+  };
+
+#elif (__SIZEOF_POINTER__ == 8)
+
+  // On 64-bits the exit code is passed explicitly.
+  template <>
+  struct operation<SEMIHOSTING_SYS_EXIT>
+  {
+    static constexpr std::size_t block_size = 2;
+
+    static inline __attribute__ ((always_inline)) void
+    pack (param_block_t* block, param_block_t reason, int code)
+    {
+      block[0] = reason;
+      block[1] = static_cast<param_block_t> (code);
+    }
+  };
+
+#endif
+
+  // --------------------------------------------------------------------------
+
+  template <int Operation, typename... Args>
+  inline __attribute__ ((always_inline)) response_t
+  call (Args&&... args)
+  {
+    static_assert (detail::packed_in_block<Operation, Args...>
+                       || detail::passed_in_register<Operation, Args...>,
+                   "Invalid arguments for this semihosting operation");
+
+    if constexpr (operation<Operation>::block_size == 0)
+      {
+        return call_host (Operation, operation<Operation>::argument (
+                                         std::forward<Args> (args)...));
+      }
+    else
+      {
+        param_block_t block[operation<Operation>::block_size];
+        operation<Operation>::pack (block, std::forward<Args> (args)...);
+        return call_host (Operation, block);
+      }
   }
 
   // --------------------------------------------------------------------------
@@ -0,0 +1,401 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_LZ_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_LZ_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+// Intentionally self contained, without the architecture definitions,
+// to be usable by the host decompressor and benchmark.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief A small LZ77 block compressor, in the LZ4 style, used by
+ * the compressed writer.
+ *
+ * @details
+ * The stream starts with an 8 bytes header:
+ *
+ * char magic[4]       "SHLZ"
+ * uint8 version       1
+ * uint8 reserved      0
+ * uint16 block_size   the maximum size of the uncompressed blocks
+ *
+ * followed by blocks, each with a 4 bytes header:
+ *
+ * uint16 size         the uncompressed size
+ * uint16 length       the size of the payload; if equal to `size`,
+ *                     the block is stored uncompressed
+ *
+ * The multi-byte values are little endian. The blocks are independent,
+ * the matches refer only to the same block.
+ *
+ * A compressed payload is a sequence of:
+ *
+ * uint8 token         literals count in the high nibble, match length
+ *                     minus 4 in the low nibble; 15 is followed by
+ *                     extension bytes, added while equal to 255
+ * uint8 literals[]
+ * uint16 offset       the distance back to the match, 1 to 65535
+ *
+ * The last sequence has only literals, and ends when the block size
+ * is reached.
+ */
+namespace micro_os_plus::semihosting::lz
+{
+  // --------------------------------------------------------------------------
+
+  constexpr char magic[4] = { 'S', 'H', 'L', 'Z' };
+  constexpr std::uint8_t version = 1;
+
+  constexpr std::size_t stream_header_size = 8;
+  constexpr std::size_t block_header_size = 4;
+
+  constexpr std::size_t max_block_size = 0xFFFF;
+  constexpr std::size_t min_match = 4;
+
+  // Marks the hash table entries without a position.
+  constexpr std::uint16_t no_position = 0xFFFF;
+
+  /**
+   * @brief Fill in the stream header.
+   */
+  void
+  put_stream_header (std::uint8_t* out, std::size_t block_size) noexcept;
+
+  /**
+   * @brief Compress a block.
+   * @param in The data.
+   * @param size The data size, at most `max_block_size`.
+   * @param out Where to store the payload.
+   * @param capacity The size available in `out`.
+   * @param table The hash table, `1 << hash_bits` entries, used as
+   * temporary storage.
+   * @param hash_bits The number of bits of the hash, 8 to 16.
+   * @return The size of the payload, or 0 if it does not fit
+   * in `capacity`.
+   */
+  std::size_t
+  compress (const std::uint8_t* in, std::size_t size, std::uint8_t* out,
+            std::size_t capacity, std::uint16_t* table,
+            unsigned int hash_bits) noexcept;
+
+  /**
+   * @brief Encode a block with its header; if compression does not
+   * make it smaller, it is stored.
+   * @param out Where to store the block, with at least
+   * `block_header_size + size` bytes.
+   * @return The size of the encoded block, including the header.
+   */
+  std::size_t
+  encode_block (const std::uint8_t* in, std::size_t size, std::uint8_t* out,
+                std::uint16_t* table, unsigned int hash_bits) noexcept;
+
+  /**
+   * @brief Decompress a payload.
+   * @return The number of bytes produced, which must be equal to
+   * `size`, or 0 if the payload is not valid.
+   */
+  std::size_t
+  decompress (const std::uint8_t* in, std::size_t length, std::uint8_t* out,
+              std::size_t size) noexcept;
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::lz
+
+// ----------------------------------------------------------------------------
+
+// Inline definitions.
+
+namespace micro_os_plus::semihosting::lz
+{
+  // --------------------------------------------------------------------------
+
+  namespace detail
+  {
+    inline void
+    put_u16 (std::uint8_t* p, std::size_t value) noexcept
+    {
+      p[0] = static_cast<std::uint8_t> (value);
+      p[1] = static_cast<std::uint8_t> (value >> 8);
+    }
+
+    inline std::uint32_t
+    load_u32 (const std::uint8_t* p) noexcept
+    {
+      std::uint32_t value;
+      std::memcpy (&value, p, sizeof (value));
+      return value;
+    }
+
+    inline std::uint32_t
+    hash (std::uint32_t value, unsigned int hash_bits) noexcept
+    {
+      return (value * 2654435761u) >> (32 - hash_bits);
+    }
+
+    // Store a length which does not fit in the token nibble.
+    inline std::uint8_t*
+    put_length (std::uint8_t* op, std::size_t length) noexcept
+    {
+      for (; length >= 255; length -= 255)
+        {
+          *op++ = 255;
+        }
+      *op++ = static_cast<std::uint8_t> (length);
+      return op;
+    }
+
+    /**
+     * Store a sequence, or return nullptr if it does not fit.
+     */
+    inline std::uint8_t*
+    put_sequence (std::uint8_t* op, const std::uint8_t* op_end,
+                  const std::uint8_t* literals, std::size_t literals_count,
+                  std::size_t offset, std::size_t match_length) noexcept
+    {
+      // The worst case size, including the length extensions.
+      std::size_t worst = 1 + literals_count + literals_count / 255 + 1
+                          + ((match_length != 0)
+                                 ? 2 + match_length / 255 + 1
+                                 : 0);
+      if (worst > static_cast<std::size_t> (op_end - op))
+        {
+          return nullptr;
+        }
+
+      std::uint8_t* token = op++;
+      std::size_t match_code
+          = (match_length != 0) ? match_length - min_match : 0;
+      *token = static_cast<std::uint8_t> (
+          ((literals_count < 15) ? literals_count : 15) << 4
+          | ((match_code < 15) ? match_code : 15));
+
+      if (literals_count >= 15)
+        {
+          op = put_length (op, literals_count - 15);
+        }
+      std::memcpy (op, literals, literals_count);
+      op += literals_count;
+
+      if (match_length != 0)
+        {
+          put_u16 (op, offset);
+          op += 2;
+          if (match_code >= 15)
+            {
+              op = put_length (op, match_code - 15);
+            }
+        }
+      return op;
+    }
+
+    /**
+     * Read a length extension, or return false at the end of the input.
+     */
+    inline bool
+    get_length (const std::uint8_t*& ip, const std::uint8_t* ip_end,
+                std::size_t& length) noexcept
+    {
+      std::uint8_t byte;
+      do
+        {
+          if (ip == ip_end)
+            {
+              return false;
+            }
+          byte = *ip++;
+          length += byte;
+        }
+      while (byte == 255);
+      return true;
+    }
+  } // namespace detail
+
+  inline void
+  put_stream_header (std::uint8_t* out, std::size_t block_size) noexcept
+  {
+    std::memcpy (out, magic, sizeof (magic));
+    out[4] = version;
+    out[5] = 0;
+    detail::put_u16 (out + 6, block_size);
+  }
+
+  inline std::size_t
+  compress (const std::uint8_t* in, std::size_t size, std::uint8_t* out,
+            std::size_t capacity, std::uint16_t* table,
+            unsigned int hash_bits) noexcept
+  {
+    std::memset (table, 0xFF, sizeof (*table) << hash_bits);
+
+    std::uint8_t* op = out;
+    const std::uint8_t* op_end = out + capacity;
+    std::size_t anchor = 0;
+    std::size_t pos = 0;
+
+    while (pos + min_match <= size)
+      {
+        std::uint32_t value = detail::load_u32 (in + pos);
+        std::uint32_t h = detail::hash (value, hash_bits);
+        std::size_t candidate = table[h];
+        table[h] = static_cast<std::uint16_t> (pos);
+
+        if (candidate == no_position
+            || detail::load_u32 (in + candidate) != value)
+          {
+            // Skip faster over the data which does not compress.
+            pos += 1 + ((pos - anchor) >> 5);
+            continue;
+          }
+
+        std::size_t length = min_match;
+        while (pos + length < size
+               && in[candidate + length] == in[pos + length])
+          {
+            ++length;
+          }
+
+        op = detail::put_sequence (op, op_end, in + anchor, pos - anchor,
+                                   pos - candidate, length);
+        if (op == nullptr)
+          {
+            return 0;
+          }
+        pos += length;
+        anchor = pos;
+      }
+
+    if (anchor < size)
+      {
+        op = detail::put_sequence (op, op_end, in + anchor, size - anchor, 0,
+                                   0);
+        if (op == nullptr)
+          {
+            return 0;
+          }
+      }
+
+    return static_cast<std::size_t> (op - out);
+  }
+
+  inline std::size_t
+  encode_block (const std::uint8_t* in, std::size_t size, std::uint8_t* out,
+                std::uint16_t* table, unsigned int hash_bits) noexcept
+  {
+    // Compressed only if at least one byte shorter.
+    std::size_t length
+        = (size > 1) ? compress (in, size, out + block_header_size, size - 1,
+                                 table, hash_bits)
+                     : 0;
+    if (length == 0)
+      {
+        std::memcpy (out + block_header_size, in, size);
+        length = size;
+      }
+
+    detail::put_u16 (out, size);
+    detail::put_u16 (out + 2, length);
+    return block_header_size + length;
+  }
+
+  inline std::size_t
+  decompress (const std::uint8_t* in, std::size_t length, std::uint8_t* out,
+              std::size_t size) noexcept
+  {
+    const std::uint8_t* ip = in;
+    const std::uint8_t* ip_end = in + length;
+    std::uint8_t* op = out;
+    std::uint8_t* op_end = out + size;
+
+    while (op < op_end)
+      {
+        if (ip == ip_end)
+          {
+            return 0;
+          }
+        std::uint8_t token = *ip++;
+
+        std::size_t literals_count = token >> 4;
+        if (literals_count == 15
+            && !detail::get_length (ip, ip_end, literals_count))
+          {
+            return 0;
+          }
+        if (literals_count > static_cast<std::size_t> (ip_end - ip)
+            || literals_count > static_cast<std::size_t> (op_end - op))
+          {
+            return 0;
+          }
+        std::memcpy (op, ip, literals_count);
+        ip += literals_count;
+        op += literals_count;
+
+        if (op == op_end)
+          {
+            break;
+          }
+
+        if (ip_end - ip < 2)
+          {
+            return 0;
+          }
+        std::size_t offset = ip[0] | static_cast<std::size_t> (ip[1]) << 8;
+        ip += 2;
+
+        std::size_t match_length = token & 0x0F;
+        if (match_length == 15
+            && !detail::get_length (ip, ip_end, match_length))
+          {
+            return 0;
+          }
+        match_length += min_match;
+
+        if (offset == 0 || offset > static_cast<std::size_t> (op - out)
+            || match_length > static_cast<std::size_t> (op_end - op))
+          {
+            return 0;
+          }
+
+        // Byte by byte, the match may overlap the output.
+        const std::uint8_t* match = op - offset;
+        for (std::size_t i = 0; i < match_length; ++i)
+          {
+            op[i] = match[i];
+          }
+        op += match_length;
+      }
+
+    return static_cast<std::size_t> (op - out);
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::lz
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_LZ_H_
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,309 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_METRICS_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_METRICS_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <micro-os-plus/semihosting.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_METRICS_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_METRICS_ARRAY_SIZE (32)
+#endif
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_METRICS_BUFFER_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_METRICS_BUFFER_SIZE (512)
+#endif
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Numeric telemetry, sampled periodically and streamed to a
+ * host file.
+ *
+ * @details
+ * The application defines named counters and gauges, usually as
+ * static objects, which register themselves; updating them is a
+ * single atomic operation, without host calls.
+ *
+ * After `start()`, the application calls `sample()` periodically
+ * (from a timer, a thread, or the main loop); each call appends to a
+ * RAM buffer a compact record with the differences since the previous
+ * sample, and the buffer is written to the host with a single
+ * `SYS_WRITE` when full.
+ *
+ * The stream is converted to CSV with `scripts/metrics-to-csv.py`.
+ */
+namespace micro_os_plus::semihosting::metrics
+{
+  // --------------------------------------------------------------------------
+
+  constexpr std::size_t max_metrics
+      = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_METRICS_ARRAY_SIZE;
+
+  static_assert (max_metrics > 0 && max_metrics <= 255,
+                 "The number of metrics must be 1 to 255");
+
+  /**
+   * @brief The base of counters and gauges; registers itself when
+   * constructed, and unregisters when destroyed.
+   */
+  class metric
+  {
+  public:
+    enum class type : std::uint8_t
+    {
+      counter = 0,
+      gauge = 1
+    };
+
+    metric (const metric&) = delete;
+
+    metric&
+    operator= (const metric&)
+        = delete;
+
+    ~metric () noexcept;
+
+    const char*
+    name (void) const noexcept;
+
+    type
+    kind (void) const noexcept;
+
+    /**
+     * @brief The current value; for gauges with a read function,
+     * the value returned by it.
+     */
+    std::uint32_t
+    value (void) const noexcept;
+
+    /**
+     * @brief False if all metrics places were used; the metric
+     * is not sampled.
+     */
+    bool
+    is_registered (void) const noexcept;
+
+  protected:
+    metric (const char* name, type kind,
+            std::int32_t (*read) (void) = nullptr) noexcept;
+
+  protected:
+    const char* name_;
+    std::int32_t (*read_) (void);
+    std::atomic<std::uint32_t> value_{ 0 };
+    type kind_;
+    bool registered_ = false;
+  };
+
+  /**
+   * @brief A counter, which only increases; the CSV shows the
+   * total count.
+   */
+  class counter : public metric
+  {
+  public:
+    explicit counter (const char* name) noexcept;
+
+    /**
+     * @brief Increment the counter; can be called from interrupts.
+     */
+    void
+    add (std::uint32_t n = 1) noexcept;
+  };
+
+  /**
+   * @brief A gauge, a signed value which may go up and down, like
+   * a queue depth or the heap usage.
+   */
+  class gauge : public metric
+  {
+  public:
+    explicit gauge (const char* name) noexcept;
+
+    /**
+     * @brief A gauge whose value is read by the sampler, for example
+     * the heap usage from the allocator.
+     */
+    gauge (const char* name, std::int32_t (*read) (void)) noexcept;
+
+    /**
+     * @brief Set the value; can be called from interrupts.
+     */
+    void
+    set (std::int32_t value) noexcept;
+
+    /**
+     * @brief Add to the value (possibly negative); can be called from
+     * interrupts.
+     */
+    void
+    add (std::int32_t n) noexcept;
+  };
+
+  /**
+   * @brief Counters, to check the stream keeps up with the sampling.
+   */
+  struct statistics
+  {
+    std::uint32_t samples;
+    // Samples not stored because the host write failed.
+    std::uint32_t dropped;
+    // Host writes.
+    std::uint32_t host_writes;
+    std::size_t bytes_written;
+  };
+
+  /**
+   * @brief Create the host file and write the names of the registered
+   * metrics; if already started, the previous stream is stopped first.
+   * @param path The host file.
+   * @return 0 if successful, or the host error code.
+   *
+   * @details
+   * Metrics registered later are not included in this stream.
+   */
+  int
+  start (host_string path) noexcept;
+
+  /**
+   * @brief Append a record with the current values to the buffer,
+   * and write the buffer to the host if full.
+   * @param timestamp The time of the sample, in application units
+   * (like milliseconds); the CSV shows it as is.
+   * @return 0 if successful, or the host error code.
+   *
+   * @details
+   * Not re-entrant; to be called from a single context.
+   */
+  int
+  sample (std::uint32_t timestamp) noexcept;
+
+  /**
+   * @brief Write the buffered records to the host.
+   * @return 0 if successful, or the host error code.
+   */
+  int
+  flush (void) noexcept;
+
+  /**
+   * @brief Write the buffered records and close the file.
+   * @return 0 if successful, or the host error code.
+   */
+  int
+  stop (void) noexcept;
+
+  bool
+  is_started (void) noexcept;
+
+  statistics
+  stats (void) noexcept;
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::metrics
+
+// ----------------------------------------------------------------------------
+
+// Inline definitions.
+
+namespace micro_os_plus::semihosting::metrics
+{
+  // --------------------------------------------------------------------------
+
+  inline const char*
+  metric::name (void) const noexcept
+  {
+    return name_;
+  }
+
+  inline metric::type
+  metric::kind (void) const noexcept
+  {
+    return kind_;
+  }
+
+  inline bool
+  metric::is_registered (void) const noexcept
+  {
+    return registered_;
+  }
+
+  inline std::uint32_t
+  metric::value (void) const noexcept
+  {
+    if (read_ != nullptr)
+      {
+        return static_cast<std::uint32_t> (read_ ());
+      }
+    return value_.load (std::memory_order_relaxed);
+  }
+
+  inline counter::counter (const char* name) noexcept
+      : metric{ name, type::counter }
+  {
+  }
+
+  inline void
+  counter::add (std::uint32_t n) noexcept
+  {
+    value_.fetch_add (n, std::memory_order_relaxed);
+  }
+
+  inline gauge::gauge (const char* name) noexcept
+      : metric{ name, type::gauge }
+  {
+  }
+
+  inline gauge::gauge (const char* name, std::int32_t (*read) (void)) noexcept
+      : metric{ name, type::gauge, read }
+  {
+  }
+
+  inline void
+  gauge::set (std::int32_t value) noexcept
+  {
+    value_.store (static_cast<std::uint32_t> (value),
+                  std::memory_order_relaxed);
+  }
+
+  inline void
+  gauge::add (std::int32_t n) noexcept
+  {
+    // Modulo 2^32, like the signed value.
+    value_.fetch_add (static_cast<std::uint32_t> (n),
+                      std::memory_order_relaxed);
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::metrics
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_METRICS_H_
+
+// ----------------------------------------------------------------------------
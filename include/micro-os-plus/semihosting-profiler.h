@@ -0,0 +1,102 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_PROFILER_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_PROFILER_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <micro-os-plus/semihosting.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief PC sampling profiler.
+ *
+ * @details
+ * The program counter is sampled from a timer interrupt, and counted
+ * in a histogram of code address buckets, kept in RAM.
+ *
+ * The application is responsible for the timer; its interrupt
+ * handler must call `sample()` with the PC of the interrupted code
+ * (for example, on Cortex-M, the PC saved in the exception frame).
+ *
+ * The histogram is written to the host in the GNU gprof `gmon.out`
+ * format, with a single `SYS_WRITE`, and can be analysed with:
+ *
+ * `arm-none-eabi-gprof -b app.elf gmon.out`
+ */
+namespace micro_os_plus::semihosting::profiler
+{
+  // --------------------------------------------------------------------------
+
+  /**
+   * @brief Clear the histogram and start sampling.
+   * @param low_pc The first address of the profiled code.
+   * @param high_pc The address after the profiled code.
+   * @param sampling_frequency_hz The frequency of the timer calling
+   * `sample()`.
+   * @return 0 if successful, or `EINVAL` if the range, rounded up to
+   * the last bucket, exceeds the address space.
+   *
+   * @details
+   * The bucket size is the smallest power of 2 that allows the entire
+   * range to fit in the histogram.
+   */
+  int
+  start (std::uintptr_t low_pc, std::uintptr_t high_pc,
+         std::uint32_t sampling_frequency_hz);
+
+  /**
+   * @brief Stop sampling; the histogram is preserved.
+   */
+  void
+  stop (void);
+
+  /**
+   * @brief Count a sample; to be called from the timer interrupt.
+   */
+  void
+  sample (std::uintptr_t pc);
+
+  /**
+   * @brief The number of samples outside the profiled range.
+   */
+  std::size_t
+  missed_samples (void);
+
+  /**
+   * @brief Stop sampling and write the histogram to a host file.
+   * @return 0 if successful, or the host error code.
+   */
+  int
+  write (host_string path);
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::profiler
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_PROFILER_H_
+
+// ----------------------------------------------------------------------------
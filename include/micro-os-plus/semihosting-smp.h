@@ -0,0 +1,312 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_SMP_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_SMP_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+// Intentionally self contained, without the architecture definitions,
+// to be usable by the host benchmark.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting::smp
+{
+  // --------------------------------------------------------------------------
+
+  /**
+   * @brief Serialise the host calls of multiple cores.
+   *
+   * @details
+   * Each core posts its requests in its own queue, a small array of
+   * slots claimed with compare-and-swap, so several threads (or an
+   * interrupt) of the same core can have requests pending at the same
+   * time; there are no locks on this path.
+   *
+   * The first caller which acquires the trap lock becomes the combiner:
+   * it executes the requests posted by all cores, in turns, then
+   * releases the lock. The others sleep until their requests are
+   * completed, or until the lock is released, when one of them takes
+   * over. Thus only one core traps at a time, and no core spins for
+   * the duration of a trap on another core.
+   *
+   * The combiner holds the lock with the interrupts of its core
+   * disabled, so it cannot be preempted by an interrupt handler, or
+   * by a thread switch, which would then wait forever for the lock.
+   * A caller which preempts the other callers of its core needs a free
+   * slot, thus `Depth` must be larger than the number of calls which
+   * can be nested on a core.
+   *
+   * A failed call (result -1) is immediately followed by `SYS_ERRNO`,
+   * and the error is kept for the core, to be returned by its next
+   * `SYS_ERRNO` request, since the host `errno` may be overwritten by
+   * the requests of the other cores in the meantime.
+   *
+   * The `Platform` class defines the types and provides the static
+   * functions:
+   * - `response_type` and `argument_type`, as for the trap;
+   * - `core_id()`, the index of the current core;
+   * - `trap(reason, arg)`, the actual host call;
+   * - `wait(address, value)`, which sleeps while `*address` is
+   *   equal to `value` (it can return early);
+   * - `notify(address)`, which wakes the cores waiting on `address`;
+   * - `interrupts_status_type`, `interrupts_disable()`, which disables
+   *   the interrupts of the current core and returns the previous
+   *   status, and `interrupts_restore(status)`.
+   */
+  template <typename Platform, std::size_t Cores, std::size_t Depth>
+  class serialiser
+  {
+  public:
+    using response_type = typename Platform::response_type;
+    using argument_type = typename Platform::argument_type;
+    using interrupts_status_type =
+        typename Platform::interrupts_status_type;
+
+    static_assert (Cores >= 1 && Depth >= 1);
+
+    // The host calls known to the serialiser.
+    static constexpr int sys_errno = 0x13;
+
+    response_type
+    call (int reason, argument_type arg) noexcept;
+
+  protected:
+    enum : std::uint32_t
+    {
+      state_free = 0,
+      state_claimed,
+      state_posted,
+      state_done
+    };
+
+    struct slot
+    {
+      std::uint32_t state;
+      int reason;
+      argument_type arg;
+      response_type result;
+    };
+
+    struct alignas (64) queue
+    {
+      slot slots[Depth];
+      // The threads waiting for a free slot.
+      std::uint32_t waiting;
+      // The error of the last failed call.
+      response_type error;
+      bool has_error;
+    };
+
+    static std::atomic_ref<std::uint32_t>
+    shared (std::uint32_t& value) noexcept
+    {
+      return std::atomic_ref<std::uint32_t> (value);
+    }
+
+    slot*
+    claim (queue& q) noexcept;
+
+    void
+    execute (std::size_t core, slot& s) noexcept;
+
+    void
+    combine (void) noexcept;
+
+    void
+    wake (void) noexcept
+    {
+      shared (generation_).fetch_add (1, std::memory_order_release);
+      Platform::notify (&generation_);
+    }
+
+    queue queues_[Cores]{};
+
+    // Incremented when requests are completed, slots are released
+    // or the lock is released; the address the waiters sleep on.
+    alignas (64) std::uint32_t generation_ = 0;
+    std::uint32_t lock_ = 0;
+  };
+
+  // --------------------------------------------------------------------------
+
+  template <typename Platform, std::size_t Cores, std::size_t Depth>
+  typename serialiser<Platform, Cores, Depth>::slot*
+  serialiser<Platform, Cores, Depth>::claim (queue& q) noexcept
+  {
+    bool is_waiting = false;
+    slot* claimed = nullptr;
+    while (claimed == nullptr)
+      {
+        std::uint32_t observed
+            = shared (generation_).load (std::memory_order_acquire);
+        for (slot& s : q.slots)
+          {
+            std::uint32_t expected = state_free;
+            if (shared (s.state).compare_exchange_strong (expected,
+                                                          state_claimed))
+              {
+                claimed = &s;
+                break;
+              }
+          }
+
+        if (claimed == nullptr)
+          {
+            if (!is_waiting)
+              {
+                // Announce the waiter, then check again, before
+                // sleeping; the slot owners wake up only if needed.
+                shared (q.waiting).fetch_add (1);
+                is_waiting = true;
+                continue;
+              }
+            Platform::wait (&generation_, observed);
+          }
+      }
+
+    if (is_waiting)
+      {
+        shared (q.waiting).fetch_sub (1);
+      }
+    return claimed;
+  }
+
+  template <typename Platform, std::size_t Cores, std::size_t Depth>
+  void
+  serialiser<Platform, Cores, Depth>::execute (std::size_t core,
+                                               slot& s) noexcept
+  {
+    queue& q = queues_[core];
+    response_type result;
+
+    if (s.reason == sys_errno && q.has_error)
+      {
+        result = q.error;
+      }
+    else
+      {
+        result = Platform::trap (s.reason, s.arg);
+        if (s.reason != sys_errno && result == -1)
+          {
+            // Before the next core changes it.
+            q.error = Platform::trap (sys_errno, argument_type{});
+            q.has_error = true;
+          }
+        else
+          {
+            q.has_error = false;
+          }
+      }
+
+    s.result = result;
+    shared (s.state).store (state_done, std::memory_order_release);
+  }
+
+  template <typename Platform, std::size_t Cores, std::size_t Depth>
+  void
+  serialiser<Platform, Cores, Depth>::combine (void) noexcept
+  {
+    // Round robin, one request per core per pass, until a pass
+    // finds nothing; bounded, to hand over the lock eventually.
+    for (std::size_t pass = 0; pass < Cores * Depth; ++pass)
+      {
+        bool found = false;
+        for (std::size_t core = 0; core < Cores; ++core)
+          {
+            for (slot& s : queues_[core].slots)
+              {
+                if (shared (s.state).load (std::memory_order_acquire)
+                    == state_posted)
+                  {
+                    execute (core, s);
+                    found = true;
+                    break;
+                  }
+              }
+          }
+        if (!found)
+          {
+            break;
+          }
+        wake ();
+      }
+  }
+
+  template <typename Platform, std::size_t Cores, std::size_t Depth>
+  typename serialiser<Platform, Cores, Depth>::response_type
+  serialiser<Platform, Cores, Depth>::call (int reason,
+                                            argument_type arg) noexcept
+  {
+    queue& q = queues_[Platform::core_id () % Cores];
+    slot* s = claim (q);
+    s->reason = reason;
+    s->arg = arg;
+    shared (s->state).store (state_posted, std::memory_order_release);
+
+    while (true)
+      {
+        // Read before checking, to not miss a wake-up.
+        std::uint32_t observed
+            = shared (generation_).load (std::memory_order_acquire);
+
+        if (shared (s->state).load (std::memory_order_acquire) == state_done)
+          {
+            break;
+          }
+
+        // Not preempted on this core while holding the lock.
+        interrupts_status_type status = Platform::interrupts_disable ();
+        if (shared (lock_).exchange (1, std::memory_order_acquire) == 0)
+          {
+            combine ();
+            shared (lock_).store (0, std::memory_order_release);
+            Platform::interrupts_restore (status);
+            wake ();
+            continue;
+          }
+        Platform::interrupts_restore (status);
+
+        Platform::wait (&generation_, observed);
+      }
+
+    response_type result = s->result;
+    shared (s->state).store (state_free);
+    if (shared (q.waiting).load () != 0)
+      {
+        wake ();
+      }
+
+    return result;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::smp
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_SMP_H_
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,154 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_SNAPSHOT_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_SNAPSHOT_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif // defined(__cplusplus)
+
+  /**
+   * @brief Hook called at startup, after the arguments are processed,
+   * before the static constructors.
+   *
+   * @details
+   * The default (weak) definition does nothing; the application
+   * redefines it to restore the snapshot, for example if a command
+   * line option asks for it.
+   */
+  void
+  micro_os_plus_semihosting_snapshot_startup (int argc, char* argv[]);
+
+#if defined(__cplusplus)
+}
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <micro-os-plus/semihosting.h>
+
+#include <cstddef>
+#include <span>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_SNAPSHOT_REGIONS_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_SNAPSHOT_REGIONS_ARRAY_SIZE (8)
+#endif
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Save RAM regions to a host file, and restore them in
+ * a later run, to skip an expensive initialisation.
+ *
+ * @details
+ * The file has a header with the build key and the address and size
+ * of each region, followed by the region contents; each region is
+ * written and read with a single host call, directly from/to memory.
+ *
+ * The snapshot is restored only if the key and the regions are
+ * identical to those saved, and the file has the expected size, so a
+ * different build, or a truncated file, leave the memory unchanged.
+ *
+ * Restoring `.data` and `.bss` as a whole would also overwrite the
+ * variables of this package (the arguments, the file descriptors, the
+ * boot profiler marks, the transport cost, the detached, trace and
+ * mailbox state) with those of the previous run. These variables are
+ * placed in the `.data.micro_os_plus_semihosting` and
+ * `.bss.micro_os_plus_semihosting` sections; when the linker script
+ * groups them between the `__semihosting_data_start__`/`_end__` and
+ * `__semihosting_bss_start__`/`_end__` symbols, `restore()` skips
+ * them. Without these symbols, the regions must not include them.
+ *
+ * The C library state (like the `malloc()` heap pointer) is not
+ * protected; it must be restored together with the heap, or not at
+ * all.
+ */
+namespace micro_os_plus::semihosting::snapshot
+{
+  // --------------------------------------------------------------------------
+
+  constexpr std::size_t max_regions
+      = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_SNAPSHOT_REGIONS_ARRAY_SIZE;
+
+  constexpr std::size_t max_key_size = 64;
+
+  /**
+   * @brief A memory region to be saved and restored.
+   */
+  struct region
+  {
+    void* address;
+    std::size_t size;
+
+    constexpr region (void* address_, std::size_t size_) noexcept
+        : address{ address_ }, size{ size_ }
+    {
+    }
+
+    // Between two linker symbols.
+    constexpr region (void* begin, void* end) noexcept
+        : address{ begin },
+          size{ static_cast<std::size_t> (static_cast<char*> (end)
+                                          - static_cast<char*> (begin)) }
+    {
+    }
+  };
+
+  /**
+   * @brief Write the regions to a host file.
+   * @param path The host file.
+   * @param regions The regions, at most `max_regions`.
+   * @param key An identifier of the build, like the GNU build ID,
+   * at most `max_key_size` bytes.
+   * @return 0 if successful, or the host error code.
+   */
+  int
+  save (host_string path, std::span<const region> regions,
+        std::span<const std::byte> key) noexcept;
+
+  /**
+   * @brief Read the regions from a host file written by `save()`.
+   * @param path The host file.
+   * @param regions The regions, identical to those saved.
+   * @param key The identifier of the build, identical to the one saved.
+   * @retval 0 The regions were restored.
+   * @retval ESTALE The file was saved by another build, or with other
+   * regions, or it is incomplete; the memory is not changed.
+   * @return Otherwise the host error code; the memory is not changed,
+   * unless the error occurred while reading the contents.
+   */
+  int
+  restore (host_string path, std::span<const region> regions,
+           std::span<const std::byte> key) noexcept;
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::snapshot
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_SNAPSHOT_H_
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_TMPFS_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_TMPFS_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <cstddef>
+
+#include <sys/types.h>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief RAM file system for scratch files.
+ *
+ * @details
+ * Files with paths starting with a configurable prefix (by default
+ * `/tmp/`) are kept in a RAM arena and never reach the host.
+ * The namespace is flat, there are no directories; the file names are
+ * the rest of the path, after the prefix.
+ *
+ * The functions are used by the POSIX system calls (`_open()`,
+ * `_read()`, `_write()`, `_lseek()`, `_rename()`, `_unlink()`);
+ * they follow the POSIX conventions, on error they set `errno`
+ * and return -1.
+ */
+namespace micro_os_plus::semihosting::tmpfs
+{
+  // --------------------------------------------------------------------------
+
+  /**
+   * @brief Check if the path is inside the RAM file system.
+   */
+  bool
+  is_tmpfs_path (const char* path) noexcept;
+
+  /**
+   * @brief Open or create a file, with the `open()` flags.
+   * @return The file index, or -1.
+   */
+  int
+  open (const char* path, int oflag) noexcept;
+
+  /**
+   * @brief Release a file index; unlinked files are removed when no
+   * longer open.
+   */
+  int
+  close (int index) noexcept;
+
+  ssize_t
+  read (int index, off_t position, void* buf, std::size_t nbyte) noexcept;
+
+  /**
+   * @brief Write at the given position, extending the file if needed;
+   * a gap after the end of the file is filled with zeros.
+   */
+  ssize_t
+  write (int index, off_t position, const void* buf,
+         std::size_t nbyte) noexcept;
+
+  off_t
+  size (int index) noexcept;
+
+  int
+  rename (const char* existing, const char* _new) noexcept;
+
+  int
+  unlink (const char* path) noexcept;
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::tmpfs
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_TMPFS_H_
+
+// ----------------------------------------------------------------------------
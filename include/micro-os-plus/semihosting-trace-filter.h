@@ -0,0 +1,173 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_TRACE_FILTER_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_TRACE_FILTER_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+// Only the trace API, without the architecture definitions, to be
+// usable by the host benchmark.
+
+#include <micro-os-plus/diag/trace.h>
+
+// ----------------------------------------------------------------------------
+
+// The level of the modules which do not define their own:
+// 0 none, 1 error, 2 warning, 3 info, 4 debug, 5 verbose.
+#if !defined(MICRO_OS_PLUS_INTEGER_TRACE_LEVEL)
+#define MICRO_OS_PLUS_INTEGER_TRACE_LEVEL (3)
+#endif
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Trace messages filtered at compile time, by level and module.
+ *
+ * @details
+ * A module is a type, usually an empty struct, which may define its
+ * own level:
+ *
+ * @code{.cpp}
+ * struct net
+ * {
+ *   static constexpr auto trace_level = trace::level::debug;
+ * };
+ *
+ * MICRO_OS_PLUS_TRACE_DEBUG (net, "rx %u bytes\n", length);
+ * @endcode
+ *
+ * The decision is a constant expression; the disabled messages are
+ * removed by the compiler, including the format strings and the
+ * evaluation of the arguments, and the enabled ones call
+ * `trace::printf()` directly, without runtime checks.
+ *
+ * Without `MICRO_OS_PLUS_TRACE`, all messages are disabled.
+ */
+namespace micro_os_plus::trace
+{
+  // --------------------------------------------------------------------------
+
+  enum class level : int
+  {
+    none = 0,
+    error = 1,
+    warning = 2,
+    info = 3,
+    debug = 4,
+    verbose = 5
+  };
+
+  constexpr level default_level
+      = static_cast<level> (MICRO_OS_PLUS_INTEGER_TRACE_LEVEL);
+
+  /**
+   * @brief The module of the messages which do not have a module;
+   * it has the default level.
+   */
+  struct default_module
+  {
+  };
+
+  namespace detail
+  {
+    template <typename Module>
+    constexpr level
+    module_level (void) noexcept
+    {
+      if constexpr (requires { Module::trace_level; })
+        {
+          return Module::trace_level;
+        }
+      else
+        {
+          return default_level;
+        }
+    }
+  } // namespace detail
+
+  /**
+   * @brief True if the messages of the level are enabled for
+   * the module.
+   */
+  template <typename Module, level Level>
+  inline constexpr bool is_enabled =
+#if defined(MICRO_OS_PLUS_TRACE)
+      Level != level::none && Level <= detail::module_level<Module> ();
+#else
+      false;
+#endif
+
+  /**
+   * @brief Write a message if the level is enabled for the module.
+   *
+   * @details
+   * The call is removed when disabled, but the arguments are still
+   * evaluated if they have side effects; the
+   * `MICRO_OS_PLUS_TRACE_<LEVEL>()` macros avoid this too.
+   */
+  template <typename Module, level Level, typename... Args>
+  inline void
+  log (const char* format, Args... args) noexcept
+  {
+    if constexpr (is_enabled<Module, Level>)
+      {
+        printf (format, args...);
+      }
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::trace
+
+// ----------------------------------------------------------------------------
+
+// The discarded branch is checked by the compiler, but not generated;
+// the arguments are not evaluated.
+#define MICRO_OS_PLUS_TRACE_LOG(module, level_, ...)                          \
+  do                                                                          \
+    {                                                                         \
+      if constexpr (::micro_os_plus::trace::is_enabled<                       \
+                        module, ::micro_os_plus::trace::level::level_>)       \
+        {                                                                     \
+          ::micro_os_plus::trace::printf (__VA_ARGS__);                       \
+        }                                                                     \
+    }                                                                         \
+  while (false)
+
+#define MICRO_OS_PLUS_TRACE_ERROR(module, ...)                                \
+  MICRO_OS_PLUS_TRACE_LOG (module, error, __VA_ARGS__)
+
+#define MICRO_OS_PLUS_TRACE_WARNING(module, ...)                              \
+  MICRO_OS_PLUS_TRACE_LOG (module, warning, __VA_ARGS__)
+
+#define MICRO_OS_PLUS_TRACE_INFO(module, ...)                                 \
+  MICRO_OS_PLUS_TRACE_LOG (module, info, __VA_ARGS__)
+
+#define MICRO_OS_PLUS_TRACE_DEBUG(module, ...)                                \
+  MICRO_OS_PLUS_TRACE_LOG (module, debug, __VA_ARGS__)
+
+#define MICRO_OS_PLUS_TRACE_VERBOSE(module, ...)                              \
+  MICRO_OS_PLUS_TRACE_LOG (module, verbose, __VA_ARGS__)
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_TRACE_FILTER_H_
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,100 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_TRACE_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_TRACE_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <micro-os-plus/semihosting.h>
+
+#include <cstddef>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Extensions of the trace API, available with the semihosting
+ * trace channels.
+ */
+namespace micro_os_plus::trace
+{
+  // --------------------------------------------------------------------------
+
+  /**
+   * @brief The layout of the lines written by `dump()`.
+   */
+  enum class dump_format
+  {
+    // Address, 16 bytes in hex and in ASCII, like `hexdump -C`.
+    hex_ascii,
+    // Address and 16 bytes in hex.
+    hex,
+    // Address and 4 words of 32 bits, in the target endianness,
+    // for register blocks.
+    words,
+  };
+
+#if defined(MICRO_OS_PLUS_TRACE)
+
+  /**
+   * @brief Write a memory region to the trace channel, in lines
+   * of 16 bytes prefixed by the address.
+   *
+   * @details
+   * The lines are accumulated in a static buffer, which is written
+   * with a single host call when full, so even large regions take
+   * only a few host calls. Not re-entrant.
+   */
+  void
+  dump (const void* data, std::size_t size,
+        dump_format format = dump_format::hex_ascii);
+
+  /**
+   * @brief Write a memory region, unformatted, to a host file;
+   * for regions too large to be inspected on the trace channel.
+   * @return 0 if successful, or the host error code.
+   */
+  int
+  dump_binary (semihosting::host_string path, const void* data,
+               std::size_t size);
+
+#else
+
+  inline void
+  dump (const void*, std::size_t, dump_format = dump_format::hex_ascii)
+  {
+  }
+
+  inline int
+  dump_binary (semihosting::host_string, const void*, std::size_t)
+  {
+    return 0;
+  }
+
+#endif // defined(MICRO_OS_PLUS_TRACE)
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::trace
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_TRACE_H_
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,163 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_TRANSPORT_COST_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_TRANSPORT_COST_H_
+
+// ----------------------------------------------------------------------------
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <micro-os-plus/semihosting.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TRANSPORT_BUFFER_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TRANSPORT_BUFFER_ARRAY_SIZE (1024)
+#endif
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TRANSPORT_ROUNDS)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TRANSPORT_ROUNDS (4)
+#endif
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief The cost of the host calls, measured on the actual
+ * transport (probe, debug server or emulator).
+ *
+ * @details
+ * The calibration times a few `SYS_ERRNO` calls, which do not move
+ * any data, and `SYS_WRITE` calls of two sizes to a scratch host
+ * file, which is removed afterwards; the minimum of several rounds is
+ * kept, and the time to read the clock is subtracted. The clock is
+ * `micro_os_plus_semihosting_clock_us()`, thus the resolution is
+ * 1 µs.
+ *
+ * The application can use the result to size its buffers and chunks
+ * at run time, for example to keep the fixed cost of the traps below
+ * a given share of the transfer time.
+ */
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  struct transport_cost
+  {
+    /**
+     * @brief The duration of a host call without data (`SYS_ERRNO`).
+     */
+    std::uint32_t trap_ns;
+
+    /**
+     * @brief The fixed duration of a `SYS_WRITE`, without the data.
+     */
+    std::uint32_t write_ns;
+
+    /**
+     * @brief The duration to transfer 1024 bytes.
+     */
+    std::uint32_t kib_ns;
+
+    /**
+     * @brief False if the calibration failed (no host clock, or the
+     * scratch file could not be written); the other members are 0.
+     */
+    bool is_valid;
+
+    /**
+     * @brief The estimated duration of a `SYS_WRITE` of `size` bytes.
+     */
+    constexpr std::uint64_t
+    write_duration_ns (std::size_t size) const noexcept;
+
+    /**
+     * @brief The smallest `SYS_WRITE` whose data transfer takes at
+     * least `percent` of the total duration (1 to 99).
+     *
+     * @details
+     * For example, with 90, the fixed cost is at most 10% of the
+     * transfer; 0 if not valid, or if the transport has no cost
+     * per byte.
+     */
+    constexpr std::size_t
+    efficient_size (unsigned int percent) const noexcept;
+  };
+
+  /**
+   * @brief Measure the transport cost, and keep it for
+   * `get_transport_cost()`.
+   *
+   * @details
+   * The duration depends on the transport; with a slow probe it is
+   * dominated by the data, `ROUNDS` times `BUFFER_ARRAY_SIZE` bytes.
+   * The callers must be serialised.
+   */
+  const transport_cost&
+  calibrate_transport (void) noexcept;
+
+  /**
+   * @brief The last measured transport cost; the first call
+   * calibrates, if not done before.
+   */
+  const transport_cost&
+  get_transport_cost (void) noexcept;
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+// Inline definitions.
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  constexpr std::uint64_t
+  transport_cost::write_duration_ns (std::size_t size) const noexcept
+  {
+    return write_ns + static_cast<std::uint64_t> (size) * kib_ns / 1024;
+  }
+
+  constexpr std::size_t
+  transport_cost::efficient_size (unsigned int percent) const noexcept
+  {
+    if (!is_valid || kib_ns == 0 || percent == 0 || percent >= 100)
+      {
+        return 0;
+      }
+    // size * kib_ns / 1024 >= percent / (100 - percent) * write_ns
+    std::uint64_t numerator
+        = static_cast<std::uint64_t> (write_ns) * 1024 * percent;
+    std::uint64_t denominator
+        = static_cast<std::uint64_t> (kib_ns) * (100 - percent);
+    return static_cast<std::size_t> ((numerator + denominator - 1)
+                                     / denominator);
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_TRANSPORT_COST_H_
+
+// ----------------------------------------------------------------------------
@@ -17,6 +17,21 @@
 
 #include <micro-os-plus/architecture.h>
 
+#include <stdint.h>
+
+// ----------------------------------------------------------------------------
+
+// The variables of this package are placed in dedicated sections,
+// which the linker script can group, between the
+// `__semihosting_data_start__`/`__semihosting_data_end__` and
+// `__semihosting_bss_start__`/`__semihosting_bss_end__` symbols,
+// so that `snapshot::restore()` does not overwrite them.
+// Without such a linker script they are part of `.data` and `.bss`.
+#define MICRO_OS_PLUS_SEMIHOSTING_DATA \
+  __attribute__ ((section (".data.micro_os_plus_semihosting")))
+#define MICRO_OS_PLUS_SEMIHOSTING_BSS \
+  __attribute__ ((section (".bss.micro_os_plus_semihosting")))
+
 #if defined(__cplusplus)
 extern "C"
 {
@@ -97,6 +112,148 @@ extern "C"
   //    int reason,
   //    micro_os_plus_semihosting_param_block_t* arg);
 
+  /**
+   * @brief Return a free running clock, in microseconds, used to
+   * measure the timeouts and the host calls.
+   *
+   * @details
+   * The clock must advance while the core is halted by the debugger;
+   * the core cycle counters (like DWT `CYCCNT`) usually stop in debug
+   * state, and cannot be used. The default (weak) definition uses the
+   * host `SYS_ELAPSED` and `SYS_TICKFREQ`, and returns 0 if the host
+   * has no clock; the application can redefine it to use a timer which
+   * is not stopped by the debugger, which is cheaper than a host call,
+   * and then define `MICRO_OS_PLUS_USE_SEMIHOSTING_LOCAL_CLOCK`, to
+   * also time the chunked transfers.
+   */
+  uint64_t
+  micro_os_plus_semihosting_clock_us (void);
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_DETACHED_MODE)
+
+  /**
+   * @brief Hook to be called by the architecture fault handler when
+   * a semihosting trap faults, i.e. when no debugger is attached.
+   * @return Non zero if the handler must skip the trap instruction
+   * and return -1 as the call result.
+   */
+  int
+  micro_os_plus_semihosting_fault_hook (void);
+
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_DETACHED_MODE)
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SMP)
+
+  /**
+   * @brief Return the index of the current core, for the multi-core
+   * serialisation of the host calls.
+   *
+   * @details
+   * The default (weak) definition reads `MPIDR` on Arm (affinity
+   * level 0) and `mhartid` on RISC-V. The application must redefine it
+   * if the cores are numbered differently, or if `mhartid` is not
+   * accessible (in S-mode or U-mode).
+   */
+  unsigned int
+  micro_os_plus_semihosting_smp_core_id (void);
+
+  /**
+   * @brief Sleep while `*address` is equal to `value`; it can return
+   * early, the caller checks again.
+   *
+   * @details
+   * The default (weak) definition uses `WFE` on Arm. RISC-V has no
+   * portable wake-up event, and `WFI` needs an interrupt to wake up,
+   * so the default is the `pause` hint, and the waiting cores spin;
+   * on RISC-V, the application must redefine it, with
+   * `micro_os_plus_semihosting_smp_notify()`, to really sleep (for
+   * example `WFI`, woken by a CLINT software interrupt). It can also
+   * be redefined to block on an RTOS event.
+   */
+  void
+  micro_os_plus_semihosting_smp_wait (const uint32_t* address,
+                                      uint32_t value);
+
+  /**
+   * @brief Wake the cores waiting on `address`.
+   *
+   * @details
+   * The default (weak) definition uses `SEV` on Arm and does nothing
+   * on RISC-V; it must match `micro_os_plus_semihosting_smp_wait()`.
+   */
+  void
+  micro_os_plus_semihosting_smp_notify (const uint32_t* address);
+
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SMP)
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SMP) \
+    || defined(MICRO_OS_PLUS_USE_SEMIHOSTING_MAILBOX)
+
+  /**
+   * @brief Disable the interrupts of the current core, and return
+   * the previous status.
+   *
+   * @details
+   * Used while the multi-core trap lock is held, and around the
+   * mailbox requests. The default (weak) definition uses `PRIMASK` on
+   * Cortex-M, `DAIF` on AArch64, `CPSR` on Cortex-A/R and
+   * `mstatus.MIE` on RISC-V (M-mode). The application must redefine
+   * it if the RTOS uses another method, or if running in S-mode or
+   * U-mode.
+   */
+  uintptr_t
+  micro_os_plus_semihosting_interrupts_disable (void);
+
+  /**
+   * @brief Restore the interrupts status returned by
+   * `micro_os_plus_semihosting_interrupts_disable()`.
+   */
+  void
+  micro_os_plus_semihosting_interrupts_restore (uintptr_t status);
+
+#endif // SMP || MAILBOX
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_MAILBOX)
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SMP)
+#error "The mailbox has a single producer, it cannot be used with SMP"
+#endif
+
+#define MICRO_OS_PLUS_SEMIHOSTING_MAILBOX_ID "SEMIHOSTING MBX"
+#define MICRO_OS_PLUS_SEMIHOSTING_MAILBOX_VERSION (1)
+
+  // Set in `host_flags` by the host while it polls the mailbox.
+#define MICRO_OS_PLUS_SEMIHOSTING_MAILBOX_HOST_POLLING (1u)
+  // Set in the record operation for output not waiting for a response.
+#define MICRO_OS_PLUS_SEMIHOSTING_MAILBOX_POSTED (0x80000000u)
+
+  /**
+   * @brief The control block of the shared memory transport, found
+   * by the host via its symbol, `micro_os_plus_semihosting_mailbox`.
+   *
+   * @details
+   * The ring buffer has a single producer, the target, which advances
+   * `write_offset`, and a single consumer, the host, which advances
+   * `read_offset`; both offsets are free running, and all values are
+   * in the target byte order.
+   */
+  typedef struct micro_os_plus_semihosting_mailbox_s
+  {
+    char id[16];
+    uint32_t version;
+    uint32_t buffer_size;
+    uint32_t host_flags;
+    uint32_t write_offset;
+    uint32_t read_offset;
+    uint32_t response_sequence;
+    uint8_t* buffer;
+    micro_os_plus_semihosting_response_t response;
+  } micro_os_plus_semihosting_mailbox_t;
+
+  extern micro_os_plus_semihosting_mailbox_t micro_os_plus_semihosting_mailbox;
+
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_MAILBOX)
+
 #if defined(__cplusplus)
 }
 #endif // defined(__cplusplus)
@@ -105,6 +262,8 @@ extern "C"
 
 #if defined(__cplusplus)
 
+#include <cstddef>
+
 // ----------------------------------------------------------------------------
 
 namespace micro_os_plus::semihosting
@@ -118,6 +277,101 @@ namespace micro_os_plus::semihosting
   response_t
   call_host (int reason, param_block_t* arg);
 
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_DETACHED_MODE)
+
+  /**
+   * @brief Check if a host is attached.
+   *
+   * @details
+   * On the first call, the host is probed with a `SYS_ERRNO` call;
+   * if it faults, the fault hook marks the host as detached, and from
+   * then on `call_host()` no longer traps, it returns failure results
+   * and discards the output.
+   */
+  bool
+  is_host_attached (void);
+
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_DETACHED_MODE)
+
+  // --------------------------------------------------------------------------
+  // Typed semihosting calls.
+
+  /**
+   * @brief A string passed to the host, as a pointer and a length.
+   *
+   * @details
+   * The length is computed with `std::char_traits<char>::length()`,
+   * which is `constexpr`; for `constexpr` objects it is computed at
+   * compile time, and for string literals passed directly it is
+   * folded by the compiler.
+   */
+  class host_string
+  {
+  public:
+    constexpr host_string (const char* str) noexcept;
+
+    constexpr host_string (const char* str, std::size_t length) noexcept;
+
+    constexpr const char*
+    data (void) const noexcept;
+
+    constexpr std::size_t
+    length (void) const noexcept;
+
+  protected:
+    static constexpr std::size_t unknown_length = ~static_cast<std::size_t> (0);
+
+    const char* data_;
+    std::size_t length_;
+  };
+
+  /**
+   * @brief The `SYS_OPEN` modes, as ISO C `fopen()` modes.
+   */
+  enum class open_mode : param_block_t
+  {
+    read = 0, // "r"
+    read_binary = 1, // "rb"
+    read_update = 2, // "r+"
+    read_update_binary = 3, // "r+b"
+    write = 4, // "w"
+    write_binary = 5, // "wb"
+    write_update = 6, // "w+"
+    write_update_binary = 7, // "w+b"
+    append = 8, // "a"
+    append_binary = 9, // "ab"
+    append_update = 10, // "a+"
+    append_update_binary = 11, // "a+b"
+  };
+
+  /**
+   * @brief Describe how the arguments of an operation are passed
+   * to the host.
+   *
+   * @details
+   * Each supported operation is a specialisation that defines either:
+   * - a `block_size` and a `pack()` function that fills a parameter
+   * block of that size, or
+   * - a `block_size` of 0 and an `argument()` function that returns the
+   * value passed directly in the parameter register.
+   *
+   * Operations without a specialisation cannot be called via `call<>()`.
+   */
+  template <int Operation>
+  struct operation;
+
+  /**
+   * @brief Call the host with the parameters checked at compile time.
+   *
+   * @details
+   * The number and the types of the arguments are validated against the
+   * `operation<>` specialisation; the parameter block is allocated
+   * on the stack with the exact size.
+   */
+  template <int Operation, typename... Args>
+  response_t
+  call (Args&&... args);
+
   // --------------------------------------------------------------------------
 } // namespace micro_os_plus::semihosting
 
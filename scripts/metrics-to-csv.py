@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+# -----------------------------------------------------------------------------
+#
+# This file is part of the µOS++ distribution.
+#   (https://github.com/micro-os-plus/)
+# Copyright (c) 2022 Liviu Ionescu
+#
+# Permission to use, copy, modify, and/or distribute this software
+# for any purpose is hereby granted, under the terms of the MIT license.
+#
+# If a copy of the license was not distributed with this file, it can
+# be obtained from https://opensource.org/licenses/MIT/.
+#
+# -----------------------------------------------------------------------------
+
+# Convert the stream written by `micro_os_plus::semihosting::metrics`
+# to CSV, one row per sample, with the timestamp and the value of each
+# metric; counters are unsigned, gauges are signed.
+#
+# Usage: metrics-to-csv.py [--output FILE] [--timestamp-scale S] metrics.bin
+#
+# A truncated last record (for example if the application did not stop
+# the stream) is ignored, with a warning.
+
+import argparse
+import csv
+import sys
+
+COUNTER = 0
+GAUGE = 1
+
+
+class Truncated(Exception):
+    pass
+
+
+def read_varint(data, offset):
+    value = 0
+    shift = 0
+    while True:
+        if offset >= len(data):
+            raise Truncated()
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return value & 0xFFFFFFFF, offset
+        shift += 7
+        if shift > 28:
+            sys.exit(f'invalid varint at {offset}')
+
+
+def unzigzag(value):
+    return (value >> 1) ^ (-(value & 1) & 0xFFFFFFFF)
+
+
+def signed(value):
+    return value - 0x100000000 if value & 0x80000000 else value
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Convert a semihosting metrics stream to CSV.')
+    parser.add_argument('--output', '-o', default='-',
+                        help='the CSV file (default stdout)')
+    parser.add_argument('--timestamp-scale', type=float, default=None,
+                        help='multiply the timestamps, e.g. 0.001 for ms '
+                        'to seconds')
+    parser.add_argument('stream', help='the stream file')
+    args = parser.parse_args()
+
+    with open(args.stream, 'rb') as f:
+        data = f.read()
+
+    if len(data) < 6 or data[0:4] != b'SHMT':
+        sys.exit(f'{args.stream}: not a metrics stream')
+    if data[4] != 1:
+        sys.exit(f'{args.stream}: unsupported version {data[4]}')
+
+    count = data[5]
+    offset = 6
+    names = []
+    kinds = []
+    for _ in range(count):
+        if offset + 2 > len(data):
+            sys.exit(f'{args.stream}: truncated header')
+        kinds.append(data[offset])
+        length = data[offset + 1]
+        offset += 2
+        names.append(data[offset:offset + length].decode('utf-8'))
+        offset += length
+        if offset > len(data):
+            sys.exit(f'{args.stream}: truncated header')
+
+    out = sys.stdout if args.output == '-' else open(args.output, 'w',
+                                                      newline='')
+    writer = csv.writer(out, lineterminator='\n')
+    writer.writerow(['timestamp'] + names)
+
+    timestamp = 0
+    values = [0] * count
+    changed_size = (count + 7) // 8
+    rows = 0
+    while offset < len(data):
+        start = offset
+        try:
+            delta, offset = read_varint(data, offset)
+            if offset + changed_size > len(data):
+                raise Truncated()
+            changed = data[offset:offset + changed_size]
+            offset += changed_size
+            for i in range(count):
+                if changed[i // 8] & (1 << (i % 8)):
+                    diff, offset = read_varint(data, offset)
+                    values[i] = (values[i] + unzigzag(diff)) & 0xFFFFFFFF
+        except Truncated:
+            print(f'{args.stream}: truncated record at {start}, ignored',
+                  file=sys.stderr)
+            break
+
+        timestamp = (timestamp + delta) & 0xFFFFFFFF
+        row = [timestamp if args.timestamp_scale is None
+               else timestamp * args.timestamp_scale]
+        for i in range(count):
+            row.append(signed(values[i]) if kinds[i] == GAUGE
+                       else values[i])
+        writer.writerow(row)
+        rows += 1
+
+    if out is not sys.stdout:
+        out.close()
+        print(f'{args.output}: {rows} samples, {count} metrics')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,208 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+/*
+ * Reference host side implementation of the batch operation used by
+ * `micro_os_plus::semihosting::batch`, to be integrated in a debug
+ * server (like OpenOCD) or an emulator (like QEMU), next to the
+ * handlers of the standard semihosting operations.
+ *
+ * The parameter block of the batch operation has two fields, the
+ * address of the requests array and the number of requests.
+ * Each request has six little endian fields, of the target word size:
+ * the operation, three parameters (as for the individual operation),
+ * the result and the error.
+ *
+ * The requests are executed in order; a handle parameter with a value
+ * of -2-k refers to the result of the request k, which must be
+ * earlier in the same batch. The result of each request is the value
+ * returned by the individual operation; if negative, the host errno
+ * is stored in the error field, otherwise 0.
+ *
+ * Only the SYS_OPEN, SYS_CLOSE, SYS_READ, SYS_WRITE and SYS_SEEK
+ * operations are accepted; the other requests are not executed, and
+ * fail with ENOSYS.
+ *
+ * The returned value is the number of executed requests, or -1
+ * if the requests cannot be accessed.
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* The services expected from the host. */
+struct semihosting_batch_host
+{
+  void* context;
+  /* 4 or 8. */
+  unsigned int word_size;
+
+  int (*read_memory) (void* context, uint64_t address, void* buffer,
+                      size_t size);
+  int (*write_memory) (void* context, uint64_t address, const void* buffer,
+                       size_t size);
+
+  /* Execute one standard operation, with the parameters already
+   * converted to host values; on failure store the errno. */
+  int64_t (*call) (void* context, int operation, const uint64_t block[3],
+                   int* error);
+};
+
+enum
+{
+  request_fields = 6,
+  field_operation = 0,
+  field_block = 1,
+  field_result = 4,
+  field_error = 5,
+  max_word_size = 8,
+
+  operation_open = 0x01,
+  operation_close = 0x02,
+  operation_write = 0x05,
+  operation_read = 0x06,
+  operation_seek = 0x0A,
+};
+
+static int
+is_batch_operation (int operation)
+{
+  switch (operation)
+    {
+    case operation_open:
+    case operation_close:
+    case operation_read:
+    case operation_write:
+    case operation_seek:
+      return 1;
+
+    default:
+      return 0;
+    }
+}
+
+static uint64_t
+load_word (const uint8_t* p, unsigned int word_size)
+{
+  uint64_t value = 0;
+  for (unsigned int i = 0; i < word_size; ++i)
+    {
+      value |= (uint64_t)p[i] << (8 * i);
+    }
+  return value;
+}
+
+static void
+store_word (uint8_t* p, unsigned int word_size, uint64_t value)
+{
+  for (unsigned int i = 0; i < word_size; ++i)
+    {
+      p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static int64_t
+sign_extend (uint64_t value, unsigned int word_size)
+{
+  if (word_size == 4)
+    {
+      return (int64_t)(int32_t)(uint32_t)value;
+    }
+  return (int64_t)value;
+}
+
+int64_t
+semihosting_batch_execute (const struct semihosting_batch_host* host,
+                           uint64_t requests, uint64_t count)
+{
+  unsigned int ws = host->word_size;
+  size_t request_size = request_fields * ws;
+
+  for (uint64_t i = 0; i < count; ++i)
+    {
+      uint8_t request[request_fields * max_word_size];
+      uint64_t address = requests + i * request_size;
+
+      if (host->read_memory (host->context, address, request, request_size)
+          != 0)
+        {
+          return (i == 0) ? -1 : (int64_t)i;
+        }
+
+      int operation = (int)load_word (&request[field_operation * ws], ws);
+      uint64_t block[3];
+      for (unsigned int k = 0; k < 3; ++k)
+        {
+          block[k] = load_word (&request[(field_block + k) * ws], ws);
+        }
+
+      if (operation != operation_open)
+        {
+          /* Resolve references to handles opened earlier. */
+          int64_t handle = sign_extend (block[0], ws);
+          if (handle <= -2)
+            {
+              uint64_t index = (uint64_t)(-2 - handle);
+              uint8_t result[max_word_size];
+              if (index < i
+                  && host->read_memory (
+                         host->context,
+                         requests + index * request_size + field_result * ws,
+                         result, ws)
+                         == 0)
+                {
+                  block[0] = (uint64_t)sign_extend (load_word (result, ws),
+                                                    ws);
+                }
+              else
+                {
+                  block[0] = (uint64_t)-1;
+                }
+            }
+        }
+
+      /* The target executes again the requests not counted; check that
+       * the result can be stored before executing, to never execute a
+       * request twice. If only the final store fails, the request stays
+       * counted, with this EIO failure as result. */
+      uint8_t output[2 * max_word_size];
+      store_word (&output[0], ws, (uint64_t)-1);
+      store_word (&output[ws], ws, EIO);
+      if (host->write_memory (host->context, address + field_result * ws,
+                              output, 2 * ws)
+          != 0)
+        {
+          return (i == 0) ? -1 : (int64_t)i;
+        }
+
+      int error = ENOSYS;
+      int64_t ret = -1;
+      if (is_batch_operation (operation))
+        {
+          error = 0;
+          ret = host->call (host->context, operation, block, &error);
+        }
+
+      store_word (&output[0], ws, (uint64_t)ret);
+      store_word (&output[ws], ws, (ret < 0) ? (uint64_t)error : 0);
+
+      if (host->write_memory (host->context, address + field_result * ws,
+                              output, 2 * ws)
+          != 0)
+        {
+          return (int64_t)(i + 1);
+        }
+    }
+
+  return (int64_t)count;
+}
@@ -0,0 +1,188 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+/*
+ * Reference host side implementation of the copy operation used by
+ * `micro_os_plus::semihosting::copy_file()` and `copy_file_range()`,
+ * to be integrated in a debug server (like OpenOCD) or an emulator
+ * (like QEMU), next to the handlers of the standard semihosting
+ * operations, on a POSIX host.
+ *
+ * The parameter block of the copy operation has six fields, of the
+ * target word size, already read by the caller; the first one selects
+ * the form:
+ * - 0, whole file: the address and the length of the source path,
+ *   the address and the length of the destination path, and 1 to
+ *   append to the destination, or 0 to replace it;
+ * - 1, range: the source handle and offset, the destination handle
+ *   and offset, and the number of bytes; the copy stops early at the
+ *   end of the source file.
+ *
+ * The returned value is the number of bytes copied, or -1, with the
+ * errno stored for `SYS_ERRNO`; ENOSYS tells the target to use
+ * another method.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <unistd.h>
+
+/* The services expected from the host. */
+struct semihosting_copy_host
+{
+  void* context;
+
+  int (*read_memory) (void* context, uint64_t address, void* buffer,
+                      size_t size);
+
+  /* The host file descriptor of a semihosting handle, or -1. */
+  int (*file_descriptor) (void* context, uint64_t handle);
+};
+
+enum
+{
+  form_file = 0,
+  form_range = 1,
+
+  max_path_size = 1024,
+  buffer_size = 64 * 1024,
+};
+
+static int
+read_path (const struct semihosting_copy_host* host, uint64_t address,
+           uint64_t length, char* path)
+{
+  if (length >= max_path_size)
+    {
+      return ENAMETOOLONG;
+    }
+  if (host->read_memory (host->context, address, path, (size_t)length) != 0)
+    {
+      return EFAULT;
+    }
+  path[length] = '\0';
+  return 0;
+}
+
+/*
+ * Copy up to `size` bytes, from the given offsets, or from the current
+ * positions if the offsets are -1. Return the number of bytes copied,
+ * or -1 if nothing was copied.
+ */
+static int64_t
+copy_data (int in, int64_t in_offset, int out, int64_t out_offset,
+           uint64_t size, int* error)
+{
+  static char buffer[buffer_size];
+  uint64_t count = 0;
+
+  while (count < size)
+    {
+      size_t n = (size - count < buffer_size) ? (size_t)(size - count)
+                                               : (size_t)buffer_size;
+      ssize_t r = (in_offset < 0) ? read (in, buffer, n)
+                                  : pread (in, buffer, n,
+                                           (off_t)((uint64_t)in_offset + count));
+      if (r < 0)
+        {
+          *error = errno;
+          return (count == 0) ? -1 : (int64_t)count;
+        }
+      if (r == 0)
+        {
+          break;
+        }
+
+      ssize_t done = 0;
+      while (done < r)
+        {
+          ssize_t w = (out_offset < 0)
+                          ? write (out, buffer + done, (size_t)(r - done))
+                          : pwrite (out, buffer + done, (size_t)(r - done),
+                                    (off_t)((uint64_t)out_offset + count));
+          if (w <= 0)
+            {
+              *error = (w < 0) ? errno : ENOSPC;
+              return (count == 0) ? -1 : (int64_t)count;
+            }
+          done += w;
+          count += (uint64_t)w;
+        }
+    }
+
+  return (int64_t)count;
+}
+
+int64_t
+semihosting_copy_execute (const struct semihosting_copy_host* host,
+                          const uint64_t fields[6], int* error)
+{
+  if (fields[0] == form_file)
+    {
+      char from[max_path_size];
+      char to[max_path_size];
+      int err = read_path (host, fields[1], fields[2], from);
+      if (err == 0)
+        {
+          err = read_path (host, fields[3], fields[4], to);
+        }
+      if (err != 0)
+        {
+          *error = err;
+          return -1;
+        }
+
+      int in = open (from, O_RDONLY);
+      if (in < 0)
+        {
+          *error = errno;
+          return -1;
+        }
+      int out = open (to,
+                      O_WRONLY | O_CREAT
+                          | ((fields[5] != 0) ? O_APPEND : O_TRUNC),
+                      0644);
+      if (out < 0)
+        {
+          *error = errno;
+          close (in);
+          return -1;
+        }
+
+      int64_t ret = copy_data (in, -1, out, -1, UINT64_MAX, error);
+      close (in);
+      if (close (out) != 0 && ret >= 0)
+        {
+          *error = errno;
+          ret = -1;
+        }
+      return ret;
+    }
+
+  if (fields[0] == form_range)
+    {
+      int in = host->file_descriptor (host->context, fields[1]);
+      int out = host->file_descriptor (host->context, fields[3]);
+      if (in < 0 || out < 0)
+        {
+          *error = EBADF;
+          return -1;
+        }
+      return copy_data (in, (int64_t)fields[2], out, (int64_t)fields[4],
+                        fields[5], error);
+    }
+
+  *error = ENOSYS;
+  return -1;
+}
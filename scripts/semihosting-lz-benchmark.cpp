@@ -0,0 +1,287 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+/*
+ * Throughput benchmark for the compressed writer
+ * (`MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_COMPRESSED_WRITER`), on Linux,
+ * with a simulated slow debug link.
+ *
+ * Build and run:
+ *   g++ -std=c++20 -O2 -I include \
+ *     scripts/semihosting-lz-benchmark.cpp -o lz-benchmark
+ *   ./lz-benchmark [KB/s [latency-us [block-size [file]]]]
+ *
+ * The simulated host sleeps for the latency of each `SYS_WRITE` plus
+ * the time to transfer the bytes at the given bandwidth. The same data
+ * is written in blocks uncompressed, and compressed, then decompressed
+ * and compared; the compression time is measured on this machine,
+ * which is much faster than a microcontroller, thus it is also shown
+ * separately.
+ *
+ * Without a file, three data sets are generated: text logs, binary
+ * records, and random bytes (which do not compress).
+ */
+
+#include <micro-os-plus/semihosting-lz.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus::semihosting;
+
+namespace
+{
+  constexpr unsigned int hash_bits = 10;
+
+  double bandwidth_bytes_per_second = 32 * 1024;
+  std::chrono::microseconds latency{ 1000 };
+
+  // The simulated host.
+  void
+  host_write (std::size_t size)
+  {
+    std::this_thread::sleep_for (
+        latency
+        + std::chrono::microseconds{ static_cast<long> (
+            static_cast<double> (size) * 1e6 / bandwidth_bytes_per_second) });
+  }
+
+  unsigned int
+  random_below (std::mt19937& rng, unsigned int limit)
+  {
+    return static_cast<unsigned int> (rng () % limit);
+  }
+
+  std::vector<std::uint8_t>
+  make_log (std::size_t size)
+  {
+    std::mt19937 rng{ 1 };
+    const char* const levels[] = { "INFO", "INFO", "INFO", "DEBUG", "WARN" };
+    std::vector<std::uint8_t> data;
+    unsigned int tick = 0;
+    while (data.size () < size)
+      {
+        tick += random_below (rng, 50);
+        const char* level = levels[random_below (rng, 5)];
+        unsigned int sensor = random_below (rng, 8);
+        unsigned int degrees = 20 + random_below (rng, 10);
+        unsigned int tenths = random_below (rng, 10);
+        unsigned int rx = random_below (rng, 1000);
+
+        char line[128];
+        int n = std::snprintf (
+            line, sizeof (line),
+            "[%10u] %-5s sensor %u: temperature=%u.%u C, rx=%u, status=ok\n",
+            tick, level, sensor, degrees, tenths, rx);
+        data.insert (data.end (), line, line + n);
+      }
+    data.resize (size);
+    return data;
+  }
+
+  std::vector<std::uint8_t>
+  make_records (std::size_t size)
+  {
+    std::mt19937 rng{ 2 };
+    // A capture of fixed size binary records, like a data logger.
+    struct record
+    {
+      std::uint16_t magic;
+      std::uint16_t channel;
+      std::uint32_t sequence;
+      std::uint32_t timestamp;
+      std::int16_t values[4];
+      std::uint8_t reserved[12];
+    };
+    std::vector<std::uint8_t> data;
+    record r{};
+    r.magic = 0xA5A5;
+    while (data.size () < size)
+      {
+        ++r.sequence;
+        r.timestamp += 100 + random_below (rng, 3);
+        r.channel = static_cast<std::uint16_t> (random_below (rng, 4));
+        for (auto& v : r.values)
+          {
+            // A slow signal with some noise.
+            v = static_cast<std::int16_t> (
+                v + static_cast<int> (random_below (rng, 5)) - 2);
+          }
+        const auto* p = reinterpret_cast<const std::uint8_t*> (&r);
+        data.insert (data.end (), p, p + sizeof (r));
+      }
+    data.resize (size);
+    return data;
+  }
+
+  std::vector<std::uint8_t>
+  make_random (std::size_t size)
+  {
+    std::mt19937 rng{ 3 };
+    std::vector<std::uint8_t> data (size);
+    for (auto& b : data)
+      {
+        b = static_cast<std::uint8_t> (rng ());
+      }
+    return data;
+  }
+
+  double
+  seconds_since (std::chrono::steady_clock::time_point start)
+  {
+    return std::chrono::duration<double> (std::chrono::steady_clock::now ()
+                                          - start)
+        .count ();
+  }
+
+  // Return false if the round trip fails.
+  bool
+  run (const char* name, const std::vector<std::uint8_t>& data,
+       std::size_t block_size)
+  {
+    // Uncompressed, one write per block.
+    auto start = std::chrono::steady_clock::now ();
+    for (std::size_t offset = 0; offset < data.size (); offset += block_size)
+      {
+        host_write (std::min (block_size, data.size () - offset));
+      }
+    double raw_seconds = seconds_since (start);
+
+    // Compressed, one write per block, as the writer does.
+    std::vector<std::uint16_t> table (1u << hash_bits);
+    std::vector<std::uint8_t> block (lz::block_header_size + block_size);
+    std::vector<std::uint8_t> stream (lz::stream_header_size);
+    lz::put_stream_header (stream.data (), block_size);
+    double compress_seconds = 0;
+
+    start = std::chrono::steady_clock::now ();
+    host_write (lz::stream_header_size);
+    for (std::size_t offset = 0; offset < data.size (); offset += block_size)
+      {
+        std::size_t size = std::min (block_size, data.size () - offset);
+        auto compress_start = std::chrono::steady_clock::now ();
+        std::size_t length = lz::encode_block (&data[offset], size,
+                                               block.data (), table.data (),
+                                               hash_bits);
+        compress_seconds += seconds_since (compress_start);
+        host_write (length);
+        stream.insert (stream.end (), block.begin (),
+                       block.begin () + static_cast<long> (length));
+      }
+    double lz_seconds = seconds_since (start);
+
+    // Round trip.
+    std::vector<std::uint8_t> restored;
+    std::vector<std::uint8_t> buffer (block_size);
+    std::size_t offset = lz::stream_header_size;
+    bool ok = true;
+    while (ok && offset + lz::block_header_size <= stream.size ())
+      {
+        std::size_t size = stream[offset] | std::size_t{ stream[offset + 1] }
+                                                << 8;
+        std::size_t length = stream[offset + 2]
+                             | std::size_t{ stream[offset + 3] } << 8;
+        offset += lz::block_header_size;
+        if (length == size)
+          {
+            restored.insert (restored.end (), &stream[offset],
+                             &stream[offset] + size);
+          }
+        else
+          {
+            ok = lz::decompress (&stream[offset], length, buffer.data (),
+                                 size)
+                 == size;
+            restored.insert (restored.end (), buffer.begin (),
+                             buffer.begin () + static_cast<long> (size));
+          }
+        offset += length;
+      }
+    ok = ok && restored == data;
+
+    double kb = static_cast<double> (data.size ()) / 1024;
+    std::printf ("%-8s %8.0f %6.2fx %9.1f %9.1f %9.1f %7s\n", name, kb,
+                 static_cast<double> (data.size ())
+                     / static_cast<double> (stream.size ()),
+                 kb / raw_seconds, kb / lz_seconds,
+                 kb / 1024 / compress_seconds, ok ? "ok" : "FAILED");
+    return ok;
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+int
+main (int argc, char* argv[])
+{
+  if (argc > 1)
+    {
+      bandwidth_bytes_per_second = 1024 * std::strtod (argv[1], nullptr);
+    }
+  if (argc > 2)
+    {
+      latency = std::chrono::microseconds{ std::strtol (argv[2], nullptr,
+                                                        0) };
+    }
+  std::size_t block_size
+      = (argc > 3) ? std::strtoul (argv[3], nullptr, 0) : 4096;
+  if (block_size < 16 || block_size > lz::max_block_size)
+    {
+      std::fprintf (stderr, "The block size must be 16 to 65535\n");
+      return 2;
+    }
+
+  std::printf ("%.0f KB/s, %ld us per write, %zu bytes blocks\n\n",
+               bandwidth_bytes_per_second / 1024,
+               static_cast<long> (latency.count ()), block_size);
+  std::printf ("%-8s %8s %7s %9s %9s %9s %7s\n", "data", "KB", "ratio",
+               "raw KB/s", "lz KB/s", "lz MB/s", "check");
+
+  bool ok = true;
+  if (argc > 4)
+    {
+      std::FILE* f = std::fopen (argv[4], "rb");
+      if (f == nullptr)
+        {
+          std::perror (argv[4]);
+          return 2;
+        }
+      std::vector<std::uint8_t> data;
+      std::uint8_t chunk[4096];
+      std::size_t n;
+      while ((n = std::fread (chunk, 1, sizeof (chunk), f)) > 0)
+        {
+          data.insert (data.end (), chunk, chunk + n);
+        }
+      std::fclose (f);
+      ok = run ("file", data, block_size);
+    }
+  else
+    {
+      constexpr std::size_t size = 128 * 1024;
+      ok = run ("log", make_log (size), block_size) && ok;
+      ok = run ("records", make_records (size), block_size) && ok;
+      ok = run ("random", make_random (size), block_size) && ok;
+    }
+
+  return ok ? 0 : 1;
+}
+
+// ----------------------------------------------------------------------------
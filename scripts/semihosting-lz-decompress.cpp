@@ -0,0 +1,139 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+/*
+ * Decompress the files written by
+ * `micro_os_plus::semihosting::compressed_writer`.
+ *
+ * Build and run:
+ *   g++ -std=c++20 -O2 -I include \
+ *     scripts/semihosting-lz-decompress.cpp -o lz-decompress
+ *   ./lz-decompress dump.lz dump.bin
+ *
+ * A truncated last block (for example if the application did not
+ * close the writer) is reported, and the data before it is kept.
+ */
+
+#include <micro-os-plus/semihosting-lz.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus::semihosting;
+
+int
+main (int argc, char* argv[])
+{
+  if (argc != 3)
+    {
+      std::fprintf (stderr, "Usage: %s input.lz output\n", argv[0]);
+      return 2;
+    }
+
+  std::FILE* in = std::fopen (argv[1], "rb");
+  if (in == nullptr)
+    {
+      std::perror (argv[1]);
+      return 1;
+    }
+
+  std::uint8_t header[lz::stream_header_size];
+  if (std::fread (header, 1, sizeof (header), in) != sizeof (header)
+      || std::memcmp (header, lz::magic, sizeof (lz::magic)) != 0)
+    {
+      std::fprintf (stderr, "%s: not a compressed stream\n", argv[1]);
+      return 1;
+    }
+  if (header[4] != lz::version)
+    {
+      std::fprintf (stderr, "%s: unsupported version %u\n", argv[1],
+                    header[4]);
+      return 1;
+    }
+  std::size_t block_size = header[6] | static_cast<std::size_t> (header[7])
+                                           << 8;
+
+  std::FILE* out = std::fopen (argv[2], "wb");
+  if (out == nullptr)
+    {
+      std::perror (argv[2]);
+      return 1;
+    }
+
+  std::vector<std::uint8_t> payload (block_size);
+  std::vector<std::uint8_t> data (block_size);
+  std::size_t total_in = sizeof (header);
+  std::size_t total_out = 0;
+  std::size_t blocks = 0;
+  int status = 0;
+
+  while (true)
+    {
+      std::uint8_t block_header[lz::block_header_size];
+      std::size_t n = std::fread (block_header, 1, sizeof (block_header), in);
+      if (n == 0)
+        {
+          break;
+        }
+
+      std::size_t size
+          = block_header[0] | static_cast<std::size_t> (block_header[1]) << 8;
+      std::size_t length
+          = block_header[2] | static_cast<std::size_t> (block_header[3]) << 8;
+      if (n != sizeof (block_header) || size > block_size || length > size
+          || std::fread (payload.data (), 1, length, in) != length)
+        {
+          std::fprintf (stderr, "%s: truncated block at %zu, ignored\n",
+                        argv[1], total_in);
+          status = 1;
+          break;
+        }
+
+      const std::uint8_t* p = payload.data ();
+      if (length != size)
+        {
+          if (lz::decompress (payload.data (), length, data.data (), size)
+              != size)
+            {
+              std::fprintf (stderr, "%s: invalid block at %zu\n", argv[1],
+                            total_in);
+              status = 1;
+              break;
+            }
+          p = data.data ();
+        }
+
+      std::fwrite (p, 1, size, out);
+      total_in += sizeof (block_header) + length;
+      total_out += size;
+      ++blocks;
+    }
+
+  std::fclose (in);
+  if (std::fclose (out) != 0)
+    {
+      std::perror (argv[2]);
+      return 1;
+    }
+
+  std::printf ("%s: %zu blocks, %zu -> %zu bytes (%.2fx)\n", argv[2], blocks,
+               total_in, total_out,
+               (total_in != 0) ? static_cast<double> (total_out)
+                                     / static_cast<double> (total_in)
+                               : 0.0);
+  return status;
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,271 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+/*
+ * Reference host side implementation of the shared memory mailbox
+ * transport (`MICRO_OS_PLUS_USE_SEMIHOSTING_MAILBOX`), to be integrated
+ * in a debug server (like OpenOCD), or in a host stand-in thread.
+ *
+ * The host finds the control block via the
+ * `micro_os_plus_semihosting_mailbox` symbol, calls
+ * `semihosting_mailbox_attach()` once, then calls
+ * `semihosting_mailbox_poll()` periodically, while the target runs.
+ *
+ * Control block layout, little endian, ws is the target word size:
+ *  0  char id[16]            "SEMIHOSTING MBX"
+ * 16  uint32 version         1
+ * 20  uint32 buffer_size     power of 2
+ * 24  uint32 host_flags      bit 0 set by the host while polling
+ * 28  uint32 write_offset    advanced by the target
+ * 32  uint32 read_offset     advanced by the host
+ * 36  uint32 response_sequence
+ * 40  word buffer            the address of the ring buffer
+ * 40+ws word response
+ *
+ * Each record has two uint32 words, the operation and the payload
+ * length, followed by the payload, padded to 8 bytes:
+ * - operation 0: padding, to be skipped;
+ * - posted operations (bit 31 set): SYS_WRITEC and SYS_WRITE0 have
+ *   the characters as payload; SYS_WRITE has the handle (one word)
+ *   followed by the data;
+ * - all other operations have the address of the parameter block
+ *   as payload (one word); they must be executed as if received via
+ *   a trap, then the result must be stored in `response` and
+ *   `response_sequence` incremented.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* The services expected from the host. */
+struct semihosting_mailbox_host
+{
+  void* context;
+  /* 4 or 8. */
+  unsigned int word_size;
+  /* The address of the control block on the target. */
+  uint64_t control;
+
+  int (*read_memory) (void* context, uint64_t address, void* buffer,
+                      size_t size);
+  int (*write_memory) (void* context, uint64_t address, const void* buffer,
+                       size_t size);
+
+  /* Execute a standard operation, with the parameter as in R1. */
+  int64_t (*call) (void* context, int operation, uint64_t parameter);
+
+  /* Write posted output; the handle is -1 for the debug console. */
+  void (*output) (void* context, int64_t handle, const uint8_t* data,
+                  size_t size);
+};
+
+enum
+{
+  offset_id = 0,
+  offset_version = 16,
+  offset_buffer_size = 20,
+  offset_host_flags = 24,
+  offset_write_offset = 28,
+  offset_read_offset = 32,
+  offset_response_sequence = 36,
+  offset_buffer = 40,
+
+  header_size = 8,
+  record_alignment = 8,
+  chunk_size = 256,
+
+  operation_write = 0x05,
+};
+
+#define POSTED (0x80000000u)
+
+static uint64_t
+load_word (const uint8_t* p, unsigned int size)
+{
+  uint64_t value = 0;
+  for (unsigned int i = 0; i < size; ++i)
+    {
+      value |= (uint64_t)p[i] << (8 * i);
+    }
+  return value;
+}
+
+static void
+store_word (uint8_t* p, unsigned int size, uint64_t value)
+{
+  for (unsigned int i = 0; i < size; ++i)
+    {
+      p[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static int
+read_u32 (const struct semihosting_mailbox_host* host, uint64_t address,
+          uint32_t* value)
+{
+  uint8_t b[4];
+  if (host->read_memory (host->context, address, b, 4) != 0)
+    {
+      return -1;
+    }
+  *value = (uint32_t)load_word (b, 4);
+  return 0;
+}
+
+static int
+write_u32 (const struct semihosting_mailbox_host* host, uint64_t address,
+           uint32_t value)
+{
+  uint8_t b[4];
+  store_word (b, 4, value);
+  return host->write_memory (host->context, address, b, 4);
+}
+
+static int
+set_host_flags (const struct semihosting_mailbox_host* host, uint32_t flags)
+{
+  return write_u32 (host, host->control + offset_host_flags, flags);
+}
+
+/* Check the id and the version, and start polling. */
+int
+semihosting_mailbox_attach (const struct semihosting_mailbox_host* host)
+{
+  static const char id[16] = "SEMIHOSTING MBX";
+  uint8_t b[20];
+
+  if (host->read_memory (host->context, host->control + offset_id, b,
+                         sizeof (b))
+      != 0)
+    {
+      return -1;
+    }
+
+  for (size_t i = 0; i < sizeof (id); ++i)
+    {
+      if (b[i] != (uint8_t)id[i])
+        {
+          return -1;
+        }
+    }
+
+  if (load_word (&b[offset_version], 4) != 1)
+    {
+      return -1;
+    }
+
+  return set_host_flags (host, 1);
+}
+
+/* Stop polling; the target falls back to traps. */
+int
+semihosting_mailbox_detach (const struct semihosting_mailbox_host* host)
+{
+  return set_host_flags (host, 0);
+}
+
+/* Process all pending records; return their number, or -1. */
+int
+semihosting_mailbox_poll (const struct semihosting_mailbox_host* host)
+{
+  unsigned int ws = host->word_size;
+  uint64_t c = host->control;
+
+  uint32_t size;
+  uint32_t w;
+  uint32_t r;
+  uint8_t b[8];
+  if (read_u32 (host, c + offset_buffer_size, &size) != 0
+      || read_u32 (host, c + offset_write_offset, &w) != 0
+      || read_u32 (host, c + offset_read_offset, &r) != 0
+      || host->read_memory (host->context, c + offset_buffer, b, ws) != 0)
+    {
+      return -1;
+    }
+  uint64_t buffer = load_word (b, ws);
+
+  int count = 0;
+  while (r != w)
+    {
+      uint64_t record = buffer + (r & (size - 1));
+      if (host->read_memory (host->context, record, b, header_size) != 0)
+        {
+          return -1;
+        }
+      uint32_t operation = (uint32_t)load_word (&b[0], 4);
+      uint32_t length = (uint32_t)load_word (&b[4], 4);
+      uint64_t payload = record + header_size;
+      uint32_t total = (header_size + length + record_alignment - 1)
+                       & ~(uint32_t)(record_alignment - 1);
+
+      if (operation & POSTED)
+        {
+          int64_t handle = -1;
+          if ((operation & ~POSTED) == operation_write)
+            {
+              if (host->read_memory (host->context, payload, b, ws) != 0)
+                {
+                  return -1;
+                }
+              handle = (int64_t)load_word (b, ws);
+              payload += ws;
+              length -= ws;
+            }
+
+          uint8_t data[chunk_size];
+          while (length > 0)
+            {
+              size_t n = (length > chunk_size) ? (size_t)chunk_size : length;
+              if (host->read_memory (host->context, payload, data, n) != 0)
+                {
+                  return -1;
+                }
+              host->output (host->context, handle, data, n);
+              payload += n;
+              length -= (uint32_t)n;
+            }
+        }
+      else if (operation != 0)
+        {
+          if (host->read_memory (host->context, payload, b, ws) != 0)
+            {
+              return -1;
+            }
+          int64_t result
+              = host->call (host->context, (int)operation, load_word (b, ws));
+
+          uint32_t sequence;
+          store_word (b, ws, (uint64_t)result);
+          if (host->write_memory (host->context, c + offset_buffer + ws, b, ws)
+                  != 0
+              || read_u32 (host, c + offset_response_sequence, &sequence) != 0)
+            {
+              return -1;
+            }
+          /* The response must be visible before the sequence. */
+          if (write_u32 (host, c + offset_response_sequence, sequence + 1)
+              != 0)
+            {
+              return -1;
+            }
+        }
+
+      r += total;
+      if (write_u32 (host, c + offset_read_offset, r) != 0)
+        {
+          return -1;
+        }
+      ++count;
+    }
+
+  return count;
+}
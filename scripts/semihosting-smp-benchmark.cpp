@@ -0,0 +1,298 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+/*
+ * Contention benchmark for the multi-core serialisation of the host
+ * calls (`MICRO_OS_PLUS_USE_SEMIHOSTING_SMP`), on Linux, with threads
+ * standing in for the cores.
+ *
+ * Build and run:
+ *   g++ -std=c++20 -O2 -pthread -I include \
+ *     scripts/semihosting-smp-benchmark.cpp -o smp-benchmark
+ *   ./smp-benchmark [threads [calls [trap-us]]]
+ *
+ * The simulated trap sleeps for the given time, like a core halted
+ * while the host processes the request, and checks that no other
+ * trap is in progress. One call in 16 fails and is followed by
+ * `SYS_ERRNO`, which must return the error of the same thread.
+ *
+ * The same load is run with a global spinlock, a mutex, and the
+ * serialiser; the CPU time shows the time wasted by the waiters.
+ */
+
+#include <micro-os-plus/semihosting-smp.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr int sys_open = 0x01;
+  constexpr int sys_errno = 0x13;
+
+  std::chrono::microseconds trap_duration{ 20 };
+
+  std::atomic<int> traps_in_progress;
+  std::atomic<unsigned long> traps;
+  std::atomic<unsigned long> overlaps;
+
+  // The host errno, shared by all cores.
+  long host_errno;
+
+  thread_local std::size_t this_core;
+
+  struct request
+  {
+    std::size_t core;
+    bool fail;
+  };
+
+  // The simulated host.
+  long
+  host_trap (int reason, void* arg)
+  {
+    if (traps_in_progress.fetch_add (1) != 0)
+      {
+        ++overlaps;
+      }
+    ++traps;
+    std::this_thread::sleep_for (trap_duration);
+
+    long result;
+    if (reason == sys_errno)
+      {
+        result = host_errno;
+      }
+    else
+      {
+        request* r = static_cast<request*> (arg);
+        if (r->fail)
+          {
+            host_errno = static_cast<long> (r->core) + 1;
+            result = -1;
+          }
+        else
+          {
+            result = static_cast<long> (r->core);
+          }
+      }
+
+    traps_in_progress.fetch_sub (1);
+    return result;
+  }
+
+  struct host_platform
+  {
+    using response_type = long;
+    using argument_type = void*;
+    // Threads, without interrupts.
+    using interrupts_status_type = int;
+
+    static std::size_t
+    core_id (void) noexcept
+    {
+      return this_core;
+    }
+
+    static response_type
+    trap (int reason, argument_type arg) noexcept
+    {
+      return host_trap (reason, arg);
+    }
+
+    static void
+    wait (const std::uint32_t* address, std::uint32_t value) noexcept
+    {
+      std::atomic_ref<std::uint32_t> (*const_cast<std::uint32_t*> (address))
+          .wait (value, std::memory_order_acquire);
+    }
+
+    static void
+    notify (const std::uint32_t* address) noexcept
+    {
+      std::atomic_ref<std::uint32_t> (*const_cast<std::uint32_t*> (address))
+          .notify_all ();
+    }
+
+    static interrupts_status_type
+    interrupts_disable (void) noexcept
+    {
+      return 0;
+    }
+
+    static void
+    interrupts_restore (interrupts_status_type) noexcept
+    {
+    }
+  };
+
+  constexpr std::size_t max_cores = 16;
+
+  micro_os_plus::semihosting::smp::serialiser<host_platform, max_cores, 4>
+      shared_serialiser;
+
+  std::atomic_flag shared_spinlock;
+  std::mutex shared_mutex;
+
+  enum class method
+  {
+    spinlock,
+    mutex,
+    serialiser
+  };
+
+  long
+  call (method m, int reason, void* arg)
+  {
+    long result;
+    switch (m)
+      {
+      case method::spinlock:
+        while (shared_spinlock.test_and_set (std::memory_order_acquire))
+          {
+          }
+        result = host_trap (reason, arg);
+        shared_spinlock.clear (std::memory_order_release);
+        return result;
+
+      case method::mutex:
+        {
+          std::lock_guard<std::mutex> lock{ shared_mutex };
+          return host_trap (reason, arg);
+        }
+
+      case method::serialiser:
+      default:
+        return shared_serialiser.call (reason, arg);
+      }
+  }
+
+  double
+  cpu_seconds (void)
+  {
+    timespec ts;
+    clock_gettime (CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<double> (ts.tv_sec)
+           + static_cast<double> (ts.tv_nsec) * 1e-9;
+  }
+
+  // Return the number of wrong results.
+  unsigned long
+  run (method m, std::size_t cores, unsigned long calls)
+  {
+    std::atomic<unsigned long> errors{ 0 };
+    std::vector<std::thread> threads;
+
+    for (std::size_t core = 0; core < cores; ++core)
+      {
+        threads.emplace_back ([=, &errors] {
+          this_core = core;
+          for (unsigned long i = 0; i < calls; ++i)
+            {
+              request r{ core, (i % 16) == 15 };
+              long result = call (m, sys_open, &r);
+              if (r.fail)
+                {
+                  if (result != -1
+                      || call (m, sys_errno, nullptr)
+                             != static_cast<long> (core) + 1)
+                    {
+                      ++errors;
+                    }
+                }
+              else if (result != static_cast<long> (core))
+                {
+                  ++errors;
+                }
+            }
+        });
+      }
+
+    for (auto& t : threads)
+      {
+        t.join ();
+      }
+    return errors;
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+int
+main (int argc, char* argv[])
+{
+  std::size_t cores = (argc > 1) ? std::strtoul (argv[1], nullptr, 0) : 2;
+  unsigned long calls = (argc > 2) ? std::strtoul (argv[2], nullptr, 0) : 2000;
+  if (argc > 3)
+    {
+      trap_duration = std::chrono::microseconds{ std::strtol (argv[3],
+                                                              nullptr, 0) };
+    }
+  if (cores < 1 || cores > max_cores)
+    {
+      std::fprintf (stderr, "The number of threads must be 1 to %zu\n",
+                    max_cores);
+      return 2;
+    }
+
+  std::printf ("%zu threads, %lu calls each, %ld us per trap\n\n", cores,
+               calls, static_cast<long> (trap_duration.count ()));
+  std::printf ("%-12s %10s %10s %10s %10s %9s %7s\n", "method", "wall ms",
+               "cpu ms", "calls/s", "traps", "overlaps", "errors");
+
+  const struct
+  {
+    method m;
+    const char* name;
+  } methods[] = {
+    { method::spinlock, "spinlock" },
+    { method::mutex, "mutex" },
+    { method::serialiser, "serialiser" },
+  };
+
+  int status = 0;
+  for (const auto& entry : methods)
+    {
+      traps = 0;
+      overlaps = 0;
+
+      double cpu_start = cpu_seconds ();
+      auto start = std::chrono::steady_clock::now ();
+      unsigned long errors = run (entry.m, cores, calls);
+      std::chrono::duration<double> wall
+          = std::chrono::steady_clock::now () - start;
+      double cpu = cpu_seconds () - cpu_start;
+
+      // Including the SYS_ERRNO calls.
+      unsigned long total = cores * (calls + calls / 16);
+      std::printf ("%-12s %10.1f %10.1f %10.0f %10lu %9lu %7lu\n",
+                   entry.name, wall.count () * 1e3, cpu * 1e3,
+                   static_cast<double> (total) / wall.count (), traps.load (),
+                   overlaps.load (), errors);
+
+      if (entry.m == method::serialiser && (overlaps != 0 || errors != 0))
+        {
+          status = 1;
+        }
+    }
+
+  return status;
+}
@@ -0,0 +1,212 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+/*
+ * Code size and time benchmark for the compile-time trace filter
+ * (`semihosting-trace-filter.h`), on Linux, compared with the same
+ * messages filtered at run time.
+ *
+ * Build and run, for several levels:
+ *   for l in 0 1 3 5; do
+ *     g++ -std=c++20 -O2 -DMICRO_OS_PLUS_TRACE \
+ *       -DMICRO_OS_PLUS_INTEGER_TRACE_LEVEL=$l \
+ *       -I include -I <diag-trace>/include \
+ *       scripts/semihosting-trace-filter-benchmark.cpp -o trace-filter-$l
+ *     ./trace-filter-$l
+ *     nm -S -C trace-filter-$l | grep process_packet
+ *   done
+ *
+ * `trace::printf()` is replaced by a stand-in which formats the
+ * message into a buffer, without output, so the times include the
+ * formatting, but not the host calls. `nm -S` shows the size of the
+ * two functions; the filtered one shrinks with the level, down to the
+ * code without any trace, while the other one keeps all messages.
+ */
+
+#include <micro-os-plus/semihosting-trace-filter.h>
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::trace
+{
+  // The stand-in for the trace channel.
+  unsigned long messages;
+  char line[200];
+
+  int
+  printf (const char* format, ...)
+  {
+    std::va_list arguments;
+    va_start (arguments, format);
+    int ret = std::vsnprintf (line, sizeof (line), format, arguments);
+    va_end (arguments);
+    ++messages;
+    return ret;
+  }
+} // namespace micro_os_plus::trace
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus;
+
+namespace
+{
+  struct net
+  {
+  };
+
+  // A module with more details than the default, unless all
+  // messages are disabled.
+  struct checksum
+  {
+    static constexpr auto trace_level
+        = (trace::default_level == trace::level::none) ? trace::level::none
+                                                       : trace::level::debug;
+  };
+
+  volatile int runtime_level = MICRO_OS_PLUS_INTEGER_TRACE_LEVEL;
+  volatile int checksum_runtime_level
+      = static_cast<int> (trace::detail::module_level<checksum> ());
+
+  // Evaluated only when the message is enabled.
+  unsigned long evaluations;
+
+  std::uint32_t
+  expensive_argument (std::uint32_t value)
+  {
+    ++evaluations;
+    return value * 2654435761u;
+  }
+
+  // A typical function, with messages of all levels.
+  __attribute__ ((noinline)) std::uint32_t
+  process_packet_filtered (const std::uint8_t* data, std::size_t size)
+  {
+    MICRO_OS_PLUS_TRACE_VERBOSE (net, "%s(%p, %zu)\n", __func__,
+                                 static_cast<const void*> (data), size);
+    if (size == 0)
+      {
+        MICRO_OS_PLUS_TRACE_ERROR (net, "empty packet\n");
+        return 0;
+      }
+
+    std::uint32_t crc = 0xFFFFFFFF;
+    for (std::size_t i = 0; i < size; ++i)
+      {
+        crc ^= data[i];
+        for (int k = 0; k < 8; ++k)
+          {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+          }
+      }
+    MICRO_OS_PLUS_TRACE_DEBUG (checksum, "crc %08x hash %08x\n", crc,
+                               expensive_argument (crc));
+
+    if (data[0] == 0xFF)
+      {
+        MICRO_OS_PLUS_TRACE_WARNING (net, "broadcast from %u\n", data[1]);
+      }
+    MICRO_OS_PLUS_TRACE_INFO (net, "packet %zu bytes\n", size);
+    return ~crc;
+  }
+
+  // The same, with the levels checked at run time.
+#define RUNTIME_TRACE(threshold, level_, ...)                                 \
+  do                                                                          \
+    {                                                                         \
+      if ((threshold) >= (level_))                                            \
+        {                                                                     \
+          trace::printf (__VA_ARGS__);                                        \
+        }                                                                     \
+    }                                                                         \
+  while (false)
+
+  __attribute__ ((noinline)) std::uint32_t
+  process_packet_runtime (const std::uint8_t* data, std::size_t size)
+  {
+    RUNTIME_TRACE (runtime_level, 5, "%s(%p, %zu)\n", __func__,
+                   static_cast<const void*> (data), size);
+    if (size == 0)
+      {
+        RUNTIME_TRACE (runtime_level, 1, "empty packet\n");
+        return 0;
+      }
+
+    std::uint32_t crc = 0xFFFFFFFF;
+    for (std::size_t i = 0; i < size; ++i)
+      {
+        crc ^= data[i];
+        for (int k = 0; k < 8; ++k)
+          {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+          }
+      }
+    RUNTIME_TRACE (checksum_runtime_level, 4, "crc %08x hash %08x\n", crc,
+                   expensive_argument (crc));
+
+    if (data[0] == 0xFF)
+      {
+        RUNTIME_TRACE (runtime_level, 2, "broadcast from %u\n", data[1]);
+      }
+    RUNTIME_TRACE (runtime_level, 3, "packet %zu bytes\n", size);
+    return ~crc;
+  }
+
+  template <typename F>
+  void
+  measure (const char* name, F function)
+  {
+    constexpr unsigned long calls = 200000;
+    std::uint8_t packet[16] = { 0xFF, 7, 1, 2, 3 };
+
+    trace::messages = 0;
+    evaluations = 0;
+    std::uint32_t sum = 0;
+    auto start = std::chrono::steady_clock::now ();
+    for (unsigned long i = 0; i < calls; ++i)
+      {
+        packet[2] = static_cast<std::uint8_t> (i);
+        sum += function (packet, sizeof (packet));
+      }
+    std::chrono::duration<double, std::nano> elapsed
+        = std::chrono::steady_clock::now () - start;
+
+    std::printf ("%-10s %10.1f %12.2f %12.2f   (%08x)\n", name,
+                 elapsed.count () / calls,
+                 static_cast<double> (trace::messages) / calls,
+                 static_cast<double> (evaluations) / calls, sum);
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+int
+main ()
+{
+  std::printf ("level %d, checksum module level %d\n\n",
+               MICRO_OS_PLUS_INTEGER_TRACE_LEVEL,
+               static_cast<int> (trace::detail::module_level<checksum> ()));
+  std::printf ("%-10s %10s %12s %12s\n", "filter", "ns/call", "messages",
+               "evaluations");
+
+  measure ("compile", process_packet_filtered);
+  measure ("run time", process_packet_runtime);
+
+  return 0;
+}
+
+// ----------------------------------------------------------------------------
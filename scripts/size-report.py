@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+# -----------------------------------------------------------------------------
+#
+# This file is part of the µOS++ distribution.
+#   (https://github.com/micro-os-plus/)
+# Copyright (c) 2022 Liviu Ionescu
+#
+# Permission to use, copy, modify, and/or distribute this software
+# for any purpose is hereby granted, under the terms of the MIT license.
+#
+# If a copy of the license was not distributed with this file, it can
+# be obtained from https://opensource.org/licenses/MIT/.
+#
+# -----------------------------------------------------------------------------
+
+# Report the .text/.data/.bss sizes of the semihosting objects, for each
+# build configuration, and compare them with a baseline, to catch
+# footprint regressions.
+#
+# Usage: size-report.py [--size TOOL] [--baseline FILE] [--key KEY]
+#            [--update] [--tolerance BYTES] [--verbose]
+#            --config NAME OBJECT... [--config NAME OBJECT...]
+#
+# The baseline file is committed, and has one entry per toolchain,
+# selected by the key. With --update, the entry is replaced by the
+# current sizes, to be committed. Without it, the exit code is 1 if
+# there is no entry for the key, or if any section of any
+# configuration grew by more than the tolerance.
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+SECTIONS = ('text', 'data', 'bss')
+
+
+def measure(size_tool, objects):
+    # The Berkeley format has one line per object:
+    # text data bss dec hex filename
+    output = subprocess.run([size_tool, '-B'] + objects, check=True,
+                            capture_output=True, text=True).stdout
+    files = {}
+    for line in output.splitlines()[1:]:
+        fields = line.split(None, 5)
+        if len(fields) < 6:
+            continue
+        name = os.path.basename(fields[5])
+        files[name] = dict(zip(SECTIONS, map(int, fields[0:3])))
+    total = {s: sum(f[s] for f in files.values()) for s in SECTIONS}
+    return total, files
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Report and check the semihosting footprint.')
+    parser.add_argument('--size', default='size',
+                        help='the binutils size tool for the target')
+    parser.add_argument('--baseline', help='the JSON file with the '
+                        'reference sizes')
+    parser.add_argument('--key', default='default',
+                        help='the toolchain entry in the baseline')
+    parser.add_argument('--update', action='store_true',
+                        help='store the current sizes as the baseline')
+    parser.add_argument('--tolerance', type=int, default=0,
+                        help='the allowed growth, in bytes')
+    parser.add_argument('--verbose', action='store_true',
+                        help='show the sizes of each object')
+    parser.add_argument('--config', nargs='+', action='append',
+                        required=True, metavar=('NAME', 'OBJECT'),
+                        help='a configuration name and its objects')
+    args = parser.parse_args()
+
+    current = {}
+    print('%-24s %8s %8s %8s' % (('configuration',) + SECTIONS))
+    for config in args.config:
+        name, objects = config[0], config[1:]
+        total, files = measure(args.size, objects)
+        current[name] = total
+        print('%-24s %8d %8d %8d' % ((name,) + tuple(
+            total[s] for s in SECTIONS)))
+        if args.verbose:
+            for file_name in sorted(files):
+                print('  %-22s %8d %8d %8d' % ((file_name,) + tuple(
+                    files[file_name][s] for s in SECTIONS)))
+
+    if args.baseline is None:
+        return 0
+
+    baselines = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baselines = json.load(f)
+
+    if args.update:
+        baselines[args.key] = current
+        with open(args.baseline, 'w') as f:
+            json.dump(baselines, f, indent=2, sort_keys=True)
+            f.write('\n')
+        print('Baseline for %s stored in %s; commit it' %
+              (args.key, args.baseline))
+        return 0
+
+    if args.key not in baselines:
+        # Not added silently, a missing entry would never fail.
+        print('No baseline for %s in %s; run with --update and commit it' %
+              (args.key, args.baseline))
+        return 1
+
+    baseline = baselines[args.key]
+    status = 0
+    for name, total in current.items():
+        if name not in baseline:
+            print('%s: not in the baseline' % name)
+            continue
+        for s in SECTIONS:
+            delta = total[s] - baseline[name].get(s, 0)
+            if delta == 0:
+                continue
+            print('%s: .%s %+d bytes' % (name, s, delta))
+            if delta > args.tolerance:
+                status = 1
+
+    if status != 0:
+        print('Footprint regression, compared to %s' % args.baseline)
+    return status
+
+
+if __name__ == '__main__':
+    sys.exit(main())
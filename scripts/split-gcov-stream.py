@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+# -----------------------------------------------------------------------------
+#
+# This file is part of the µOS++ distribution.
+#   (https://github.com/micro-os-plus/)
+# Copyright (c) 2022 Liviu Ionescu
+#
+# Permission to use, copy, modify, and/or distribute this software
+# for any purpose is hereby granted, under the terms of the MIT license.
+#
+# If a copy of the license was not distributed with this file, it can
+# be obtained from https://opensource.org/licenses/MIT/.
+#
+# -----------------------------------------------------------------------------
+
+# Recreate the individual .gcda files from the stream written by
+# `micro_os_plus::semihosting::gcov::dump()`.
+#
+# Usage: split-gcov-stream.py [--prefix-strip PATH] [--prefix PATH] gcda.stream
+
+import argparse
+import os
+import struct
+import sys
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Split a semihosting gcov stream into .gcda files.')
+    parser.add_argument('--prefix-strip', default='',
+                        help='remove this prefix from the target paths')
+    parser.add_argument('--prefix', default='',
+                        help='prepend this folder to the target paths')
+    parser.add_argument('stream', help='the stream file')
+    args = parser.parse_args()
+
+    with open(args.stream, 'rb') as f:
+        data = f.read()
+
+    if len(data) < 8 or data[0:4] != b'SHGC':
+        sys.exit(f'{args.stream}: not a gcov stream')
+
+    (version,) = struct.unpack_from('<I', data, 4)
+    if version != 1:
+        sys.exit(f'{args.stream}: unsupported version {version}')
+
+    files = {}
+    name = None
+    offset = 8
+    while offset < len(data):
+        if offset + 5 > len(data):
+            sys.exit(f'{args.stream}: truncated record at {offset}')
+        kind = data[offset:offset + 1]
+        (length,) = struct.unpack_from('<I', data, offset + 1)
+        offset += 5
+        payload = data[offset:offset + length]
+        if len(payload) != length:
+            sys.exit(f'{args.stream}: truncated record at {offset - 5}')
+        offset += length
+
+        if kind == b'F':
+            name = payload.decode('utf-8')
+            files[name] = bytearray()
+        elif kind == b'D':
+            if name is None:
+                sys.exit(f'{args.stream}: data without file name')
+            files[name] += payload
+        else:
+            sys.exit(f'{args.stream}: unknown record {kind!r}')
+
+    for name, content in files.items():
+        path = name
+        if args.prefix_strip and path.startswith(args.prefix_strip):
+            path = path[len(args.prefix_strip):].lstrip('/')
+        if args.prefix:
+            path = os.path.join(args.prefix, path.lstrip('/'))
+        folder = os.path.dirname(path)
+        if folder:
+            os.makedirs(folder, exist_ok=True)
+        with open(path, 'wb') as f:
+            f.write(content)
+        print(f'{path}: {len(content)} bytes')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,164 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BATCH)
+
+#include <micro-os-plus/semihosting-batch.h>
+
+#include <cerrno>
+
+// ----------------------------------------------------------------------------
+
+// The user defined operation (0x100-0x1FF) used to pass an entire
+// batch to the host; if not defined, the requests are always
+// executed as individual calls.
+// #define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BATCH_OPERATION (0x101)
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BATCH_OPERATION)
+  // Set when the host rejects the batch operation, to avoid
+  // trying again.
+  MICRO_OS_PLUS_SEMIHOSTING_BSS bool is_batch_unsupported;
+
+  // Set after the first batch accepted by the host.
+  MICRO_OS_PLUS_SEMIHOSTING_BSS bool is_batch_supported;
+#endif
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  int
+  batch::run (void) noexcept
+  {
+    std::size_t executed = 0;
+
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BATCH_OPERATION)
+    if (size_ > 0 && !is_batch_unsupported)
+      {
+        param_block_t fields[2];
+        fields[0] = detail::to_field (&requests_[0]);
+        fields[1] = size_;
+
+        response_t ret = call_host (
+            MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BATCH_OPERATION, fields);
+        if (ret < 0)
+          {
+            // Many hosts (like OpenOCD and QEMU) fail the unknown
+            // operations without setting ENOSYS, so a failure before
+            // any success means no support. Once the host proved
+            // support, other errors (like the requests not being
+            // accessible) are not final; the requests are executed
+            // one by one.
+            if (!is_batch_supported
+                || call<SEMIHOSTING_SYS_ERRNO> () == ENOSYS)
+              {
+                is_batch_unsupported = true;
+              }
+          }
+        else
+          {
+            is_batch_supported = true;
+            executed = (static_cast<std::size_t> (ret) < size_)
+                           ? static_cast<std::size_t> (ret)
+                           : size_;
+          }
+      }
+#endif
+
+    // Whatever the host did not execute.
+    replay (executed);
+
+    for (std::size_t i = 0; i < size_; ++i)
+      {
+        if (requests_[i].error != 0)
+          {
+            return static_cast<int> (requests_[i].error);
+          }
+      }
+
+    return 0;
+  }
+
+  /**
+   * @details
+   * This is also the reference for the behaviour of the host
+   * implementation.
+   */
+  void
+  batch::replay (std::size_t first) noexcept
+  {
+    for (std::size_t i = first; i < size_; ++i)
+      {
+        request& r = requests_[i];
+
+        param_block_t block[3] = { r.block[0], r.block[1], r.block[2] };
+        int operation = static_cast<int> (r.operation);
+
+        if (operation != SEMIHOSTING_SYS_OPEN)
+          {
+            // Resolve references to the handles opened earlier.
+            response_t handle = static_cast<response_t> (block[0]);
+            if (handle <= result_of (0))
+              {
+                std::size_t index = static_cast<std::size_t> (
+                    result_of (0) - static_cast<int> (handle));
+                block[0] = (index < i) ? requests_[index].result
+                                       : static_cast<param_block_t> (-1);
+              }
+          }
+
+        response_t ret = call_host (operation, block);
+        r.result = static_cast<param_block_t> (ret);
+        if (ret < 0)
+          {
+            int err = static_cast<int> (call<SEMIHOSTING_SYS_ERRNO> ());
+            r.error = static_cast<param_block_t> ((err != 0) ? err : EIO);
+          }
+        else
+          {
+            r.error = 0;
+          }
+      }
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BATCH)
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,406 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BLOCK_DEVICE)
+
+#include <micro-os-plus/semihosting-block-device.h>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  block_device::~block_device () noexcept
+  {
+    close ();
+  }
+
+  int
+  block_device::open (host_string path) noexcept
+  {
+    close ();
+
+    int err = file_.open (path, open_mode::read_update_binary);
+    if (err != 0)
+      {
+        return err;
+      }
+
+    auto res = file_.size ();
+    if (!res)
+      {
+        file_.close ();
+        return res.error;
+      }
+
+    sectors_ = res.count / sector_size;
+    position_ = 0;
+    tick_ = 0;
+    for (auto& s : slots_)
+      {
+        s.is_valid = false;
+        s.is_dirty = false;
+      }
+
+    return 0;
+  }
+
+  int
+  block_device::close (void) noexcept
+  {
+    if (!file_.is_open ())
+      {
+        return 0;
+      }
+
+    int err = sync ();
+    int close_err = file_.close ();
+
+    sectors_ = 0;
+    position_ = unknown_position;
+    for (auto& s : slots_)
+      {
+        s.is_valid = false;
+        s.is_dirty = false;
+      }
+
+    return (err != 0) ? err : close_err;
+  }
+
+  int
+  block_device::read (std::size_t sector, void* buffer,
+                      std::size_t count) noexcept
+  {
+    if (!file_.is_open ())
+      {
+        return EBADF;
+      }
+
+    if (sector >= sectors_ || count > sectors_ - sector)
+      {
+        return EINVAL;
+      }
+
+    std::byte* p = static_cast<std::byte*> (buffer);
+    while (count > 0)
+      {
+        std::size_t index = find (sector);
+        if (index != cache_size)
+          {
+            ++stats_.hits;
+            slots_[index].last_used = ++tick_;
+            std::memcpy (p, data_[index], sector_size);
+
+            ++sector;
+            p += sector_size;
+            --count;
+            continue;
+          }
+
+        // Group all consecutive sectors not in the cache.
+        std::size_t run = 1;
+        while (run < count && find (sector + run) == cache_size)
+          {
+            ++run;
+          }
+        stats_.misses += run;
+
+        int err;
+        if (run == 1)
+          {
+            // Probably file system metadata, keep it in the cache.
+            err = allocate (sector, index);
+            if (err != 0)
+              {
+                return err;
+              }
+
+            err = host_read (sector, data_[index], 1);
+            if (err != 0)
+              {
+                slots_[index].is_valid = false;
+                return err;
+              }
+            std::memcpy (p, data_[index], sector_size);
+          }
+        else
+          {
+            // Bulk data, read it directly, bypassing the cache.
+            err = host_read (sector, p, run);
+            if (err != 0)
+              {
+                return err;
+              }
+          }
+
+        sector += run;
+        p += run * sector_size;
+        count -= run;
+      }
+
+    return 0;
+  }
+
+  int
+  block_device::write (std::size_t sector, const void* buffer,
+                       std::size_t count) noexcept
+  {
+    if (!file_.is_open ())
+      {
+        return EBADF;
+      }
+
+    if (sector >= sectors_ || count > sectors_ - sector)
+      {
+        return EINVAL;
+      }
+
+    const std::byte* p = static_cast<const std::byte*> (buffer);
+    for (; count > 0; ++sector, p += sector_size, --count)
+      {
+        std::size_t index = find (sector);
+        if (index == cache_size)
+          {
+            // The entire sector is overwritten, no need to read it.
+            int err = allocate (sector, index);
+            if (err != 0)
+              {
+                return err;
+              }
+          }
+
+        std::memcpy (data_[index], p, sector_size);
+        slots_[index].is_dirty = true;
+        slots_[index].last_used = ++tick_;
+      }
+
+    return 0;
+  }
+
+  /**
+   * @details
+   * The dirty sectors are written in ascending order; for each run
+   * of adjacent sectors, the slots are first rearranged at the
+   * beginning of the cache, so the run can be written with a single
+   * `SYS_WRITE`.
+   */
+  int
+  block_device::sync (void) noexcept
+  {
+    while (true)
+      {
+        // Find the first dirty sector.
+        std::size_t first = cache_size;
+        for (std::size_t i = 0; i < cache_size; ++i)
+          {
+            if (slots_[i].is_valid && slots_[i].is_dirty
+                && (first == cache_size
+                    || slots_[i].sector < slots_[first].sector))
+              {
+                first = i;
+              }
+          }
+
+        if (first == cache_size)
+          {
+            return 0;
+          }
+
+        std::size_t sector = slots_[first].sector;
+        std::size_t run = 0;
+        std::size_t index = first;
+        while (true)
+          {
+            swap_slots (index, run);
+            ++run;
+            if (run == cache_size)
+              {
+                break;
+              }
+            index = find (sector + run);
+            if (index == cache_size || !slots_[index].is_dirty)
+              {
+                break;
+              }
+          }
+
+        int err = host_write (sector, data_[0], run);
+        if (err != 0)
+          {
+            return err;
+          }
+
+        for (std::size_t i = 0; i < run; ++i)
+          {
+            slots_[i].is_dirty = false;
+          }
+      }
+  }
+
+  std::size_t
+  block_device::find (std::size_t sector) noexcept
+  {
+    for (std::size_t i = 0; i < cache_size; ++i)
+      {
+        if (slots_[i].is_valid && slots_[i].sector == sector)
+          {
+            return i;
+          }
+      }
+    return cache_size;
+  }
+
+  /**
+   * @details
+   * Reuse an empty slot, or the least recently used one; if it is
+   * dirty, all dirty sectors are written back, in a single batch.
+   */
+  int
+  block_device::allocate (std::size_t sector, std::size_t& index) noexcept
+  {
+    std::size_t victim = 0;
+    for (std::size_t i = 0; i < cache_size; ++i)
+      {
+        if (!slots_[i].is_valid)
+          {
+            victim = i;
+            break;
+          }
+        if (slots_[i].last_used < slots_[victim].last_used)
+          {
+            victim = i;
+          }
+      }
+
+    if (slots_[victim].is_valid && slots_[victim].is_dirty)
+      {
+        std::size_t victim_sector = slots_[victim].sector;
+
+        int err = sync ();
+        if (err != 0)
+          {
+            return err;
+          }
+
+        // The slots may have been moved.
+        victim = find (victim_sector);
+      }
+
+    slots_[victim].sector = sector;
+    slots_[victim].is_valid = true;
+    slots_[victim].is_dirty = false;
+    slots_[victim].last_used = ++tick_;
+
+    index = victim;
+    return 0;
+  }
+
+  void
+  block_device::swap_slots (std::size_t a, std::size_t b) noexcept
+  {
+    if (a != b)
+      {
+        std::swap (slots_[a], slots_[b]);
+        std::swap (data_[a], data_[b]);
+      }
+  }
+
+  int
+  block_device::seek (std::size_t sector) noexcept
+  {
+    if (position_ == sector)
+      {
+        return 0;
+      }
+
+    ++stats_.host_seeks;
+    int err = file_.seek (sector * sector_size);
+    if (err != 0)
+      {
+        position_ = unknown_position;
+        return err;
+      }
+
+    position_ = sector;
+    return 0;
+  }
+
+  int
+  block_device::host_read (std::size_t sector, std::byte* buffer,
+                           std::size_t count) noexcept
+  {
+    int err = seek (sector);
+    if (err != 0)
+      {
+        return err;
+      }
+
+    ++stats_.host_reads;
+    auto res = file_.read ({ buffer, count * sector_size });
+    if (!res || res.count != count * sector_size)
+      {
+        position_ = unknown_position;
+        return res ? EIO : res.error;
+      }
+
+    position_ = sector + count;
+    return 0;
+  }
+
+  int
+  block_device::host_write (std::size_t sector, const std::byte* buffer,
+                            std::size_t count) noexcept
+  {
+    int err = seek (sector);
+    if (err != 0)
+      {
+        return err;
+      }
+
+    ++stats_.host_writes;
+    auto res = file_.write ({ buffer, count * sector_size });
+    if (!res || res.count != count * sector_size)
+      {
+        position_ = unknown_position;
+        return res ? EIO : res.error;
+      }
+
+    position_ = sector + count;
+    return 0;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BLOCK_DEVICE)
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
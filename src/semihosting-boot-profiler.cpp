@@ -0,0 +1,330 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BOOT_PROFILER)
+
+#include <micro-os-plus/semihosting-boot-profiler.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BOOT_PROFILER_MARKS_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BOOT_PROFILER_MARKS_ARRAY_SIZE (16)
+#endif
+
+// If the counter frequency is known, define it here, to skip the
+// calibration via the host.
+// #define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BOOT_PROFILER_CYCLES_PER_SECOND
+
+// The duration of the calibration busy loop, in counter cycles.
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BOOT_PROFILER_WINDOW_CYCLES)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BOOT_PROFILER_WINDOW_CYCLES (4000000)
+#endif
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr std::size_t marks_size
+      = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BOOT_PROFILER_MARKS_ARRAY_SIZE;
+
+  constexpr std::size_t name_width = 24;
+  constexpr std::size_t number_width = 12;
+  constexpr std::size_t line_length = name_width + 2 * number_width + 1;
+
+  struct mark_entry
+  {
+    const char* name;
+    std::uint32_t cycles;
+  };
+
+  MICRO_OS_PLUS_SEMIHOSTING_BSS mark_entry marks[marks_size];
+  MICRO_OS_PLUS_SEMIHOSTING_BSS std::size_t marks_count;
+
+  // The marks which did not fit.
+  MICRO_OS_PLUS_SEMIHOSTING_BSS std::size_t dropped_count;
+
+  MICRO_OS_PLUS_SEMIHOSTING_BSS bool is_reported;
+
+  // Header, one line per mark, total, dropped and the terminator.
+  MICRO_OS_PLUS_SEMIHOSTING_BSS char
+      report_buffer[(marks_size + 4) * line_length + 1];
+
+  std::int64_t
+  host_ticks (void)
+  {
+    std::uint64_t ticks = 0;
+    if (semihosting::call<SEMIHOSTING_SYS_ELAPSED> (&ticks) != 0)
+      {
+        return -1;
+      }
+    return static_cast<std::int64_t> (ticks);
+  }
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BOOT_PROFILER_CYCLES_PER_SECOND)
+
+  /**
+   * Measure the counter frequency over a busy loop without host calls,
+   * bracketed by two `SYS_ELAPSED`; the counters of many cores stop
+   * while the core is halted for a trap, so the interval must not
+   * include any other trap. The duration of a trap, measured with two
+   * consecutive `SYS_ELAPSED`, is subtracted. Return 0 if not known.
+   */
+  std::uint64_t
+  calibrate (void)
+  {
+    semihosting::response_t frequency
+        = semihosting::call<SEMIHOSTING_SYS_TICKFREQ> ();
+    std::int64_t previous_ticks = host_ticks ();
+    std::int64_t start_ticks = host_ticks ();
+    std::uint32_t start = micro_os_plus_semihosting_boot_cycles ();
+
+    constexpr std::uint32_t window
+        = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BOOT_PROFILER_WINDOW_CYCLES;
+    std::uint32_t cycles = 0;
+    // Bounded, in case the counter does not run; each iteration takes
+    // more than one cycle.
+    for (std::uint32_t i = 0; i < window && cycles < window; ++i)
+      {
+        cycles = micro_os_plus_semihosting_boot_cycles () - start;
+      }
+
+    std::int64_t end_ticks = host_ticks ();
+    if (frequency <= 0 || previous_ticks < 0 || end_ticks < 0
+        || cycles == 0)
+      {
+        return 0;
+      }
+
+    std::int64_t trap_ticks = start_ticks - previous_ticks;
+    std::int64_t elapsed_ticks = end_ticks - start_ticks - trap_ticks;
+    if (elapsed_ticks <= 0)
+      {
+        return 0;
+      }
+
+    return static_cast<std::uint64_t> (cycles)
+           * static_cast<std::uint64_t> (frequency)
+           / static_cast<std::uint64_t> (elapsed_ticks);
+  }
+
+#endif
+
+  char*
+  put_text (char* p, const char* str, std::size_t width)
+  {
+    std::size_t i = 0;
+    for (; i < width - 1 && str[i] != '\0'; ++i)
+      {
+        *p++ = str[i];
+      }
+    for (; i < width; ++i)
+      {
+        *p++ = ' ';
+      }
+    return p;
+  }
+
+  // Right aligned, for the column titles.
+  char*
+  put_title (char* p, const char* str, std::size_t width)
+  {
+    std::size_t length = 0;
+    while (str[length] != '\0')
+      {
+        ++length;
+      }
+    for (std::size_t i = length; i < width; ++i)
+      {
+        *p++ = ' ';
+      }
+    for (std::size_t i = 0; i < length; ++i)
+      {
+        *p++ = str[i];
+      }
+    return p;
+  }
+
+  // Right aligned; values too large are shown as `*`.
+  char*
+  put_number (char* p, std::uint64_t value, std::size_t width)
+  {
+    char digits[20];
+    std::size_t n = 0;
+    do
+      {
+        digits[n++] = static_cast<char> ('0' + value % 10);
+        value /= 10;
+      }
+    while (value != 0 && n < sizeof (digits));
+
+    if (n >= width)
+      {
+        n = 1;
+        digits[0] = '*';
+      }
+    for (std::size_t i = n; i < width; ++i)
+      {
+        *p++ = ' ';
+      }
+    while (n > 0)
+      {
+        *p++ = digits[--n];
+      }
+    return p;
+  }
+
+  char*
+  put_line (char* p, const char* name, std::uint32_t cycles,
+            std::uint64_t cycles_per_second)
+  {
+    p = put_text (p, name, name_width);
+    p = put_number (p, cycles, number_width);
+    if (cycles_per_second != 0)
+      {
+        p = put_number (p, cycles * 1000000ull / cycles_per_second,
+                        number_width);
+      }
+    *p++ = '\n';
+    return p;
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+uint32_t __attribute__ ((weak)) micro_os_plus_semihosting_boot_cycles (void)
+{
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) \
+    || defined(__ARM_ARCH_8M_MAIN__) || defined(__ARM_ARCH_8_1M_MAIN__)
+  // DWT CYCCNT, enabled on first use.
+  volatile std::uint32_t* demcr
+      = reinterpret_cast<volatile std::uint32_t*> (0xE000EDFC);
+  volatile std::uint32_t* dwt_ctrl
+      = reinterpret_cast<volatile std::uint32_t*> (0xE0001000);
+  volatile std::uint32_t* dwt_cyccnt
+      = reinterpret_cast<volatile std::uint32_t*> (0xE0001004);
+
+  if ((*dwt_ctrl & 1u) == 0)
+    {
+      *demcr = *demcr | (1u << 24); // TRCENA
+      *dwt_ctrl = *dwt_ctrl | 1u; // CYCCNTENA
+    }
+  return *dwt_cyccnt;
+#elif defined(__riscv)
+  unsigned long cycles;
+  asm volatile("csrr %0, mcycle" : "=r"(cycles));
+  return static_cast<std::uint32_t> (cycles);
+#elif defined(__aarch64__)
+  std::uint64_t count;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(count));
+  return static_cast<std::uint32_t> (count);
+#else
+  // No local counter, use the host ticks; expensive, but still usable.
+  return static_cast<std::uint32_t> (host_ticks ());
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting::boot_profiler
+{
+  // --------------------------------------------------------------------------
+
+  void
+  mark (const char* name) noexcept
+  {
+    std::uint32_t cycles = micro_os_plus_semihosting_boot_cycles ();
+    if (marks_count < marks_size)
+      {
+        marks[marks_count].name = name;
+        marks[marks_count].cycles = cycles;
+        ++marks_count;
+      }
+    else
+      {
+        ++dropped_count;
+      }
+  }
+
+  void
+  report (void) noexcept
+  {
+    if (is_reported || marks_count == 0)
+      {
+        return;
+      }
+    is_reported = true;
+
+    std::uint64_t cycles_per_second = 0;
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BOOT_PROFILER_CYCLES_PER_SECOND)
+    cycles_per_second
+        = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BOOT_PROFILER_CYCLES_PER_SECOND;
+#else
+    cycles_per_second = calibrate ();
+#endif
+
+    char* p = report_buffer;
+    p = put_text (p, "boot phase", name_width);
+    p = put_title (p, "cycles", number_width);
+    if (cycles_per_second != 0)
+      {
+        p = put_title (p, "us", number_width);
+      }
+    *p++ = '\n';
+
+    for (std::size_t i = 1; i < marks_count; ++i)
+      {
+        p = put_line (p, marks[i].name, marks[i].cycles - marks[i - 1].cycles,
+                      cycles_per_second);
+      }
+    p = put_line (p, "total", marks[marks_count - 1].cycles - marks[0].cycles,
+                  cycles_per_second);
+
+    if (dropped_count != 0)
+      {
+        p = put_text (p, "dropped marks", name_width);
+        p = put_number (p, dropped_count, number_width);
+        *p++ = '\n';
+      }
+    *p = '\0';
+
+    // A single host call.
+    call<SEMIHOSTING_SYS_WRITE0> (report_buffer);
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::boot_profiler
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BOOT_PROFILER)
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
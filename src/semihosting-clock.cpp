@@ -0,0 +1,64 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#include <micro-os-plus/semihosting.h>
+
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus;
+
+// ----------------------------------------------------------------------------
+
+// In its own unit, since it is used by several components, not all
+// of them based on the file class.
+uint64_t __attribute__ ((weak)) micro_os_plus_semihosting_clock_us (void)
+{
+  // 0 if not known yet, -1 if the host has no clock.
+  static MICRO_OS_PLUS_SEMIHOSTING_BSS int64_t ticks_per_second;
+  if (ticks_per_second == 0)
+    {
+      semihosting::response_t frequency
+          = semihosting::call<SEMIHOSTING_SYS_TICKFREQ> ();
+      ticks_per_second = (frequency > 0) ? frequency : -1;
+    }
+  if (ticks_per_second < 0)
+    {
+      return 0;
+    }
+
+  uint64_t frequency = static_cast<uint64_t> (ticks_per_second);
+  uint64_t ticks = 0;
+  if (semihosting::call<SEMIHOSTING_SYS_ELAPSED> (&ticks) != 0)
+    {
+      return 0;
+    }
+  // In two parts, to avoid the overflow.
+  return ticks / frequency * 1000000
+         + ticks % frequency * 1000000 / frequency;
+}
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
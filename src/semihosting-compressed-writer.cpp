@@ -0,0 +1,175 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_COMPRESSED_WRITER)
+
+#include <micro-os-plus/semihosting-compressed-writer.h>
+
+#include <cerrno>
+#include <cstring>
+#include <span>
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  compressed_writer::~compressed_writer () noexcept
+  {
+    close ();
+  }
+
+  int
+  compressed_writer::open (host_string path) noexcept
+  {
+    close ();
+
+    int err = file_.open (path, open_mode::write_binary);
+    if (err != 0)
+      {
+        return err;
+      }
+
+    used_ = 0;
+    stats_ = {};
+
+    std::uint8_t header[lz::stream_header_size];
+    lz::put_stream_header (header, block_size);
+    auto res = file_.write (std::span<const std::byte>{
+        reinterpret_cast<const std::byte*> (header), sizeof (header) });
+    ++stats_.host_writes;
+    if (!res || res.count != sizeof (header))
+      {
+        file_.close ();
+        return res ? ENOSPC : res.error;
+      }
+    stats_.bytes_out = sizeof (header);
+
+    return 0;
+  }
+
+  int
+  compressed_writer::close (void) noexcept
+  {
+    if (!file_.is_open ())
+      {
+        return 0;
+      }
+
+    int err = flush ();
+    int close_err = file_.close ();
+
+    return (err != 0) ? err : close_err;
+  }
+
+  int
+  compressed_writer::write (const void* data, std::size_t size) noexcept
+  {
+    if (!file_.is_open ())
+      {
+        return EBADF;
+      }
+
+    const std::uint8_t* p = static_cast<const std::uint8_t*> (data);
+    while (size > 0)
+      {
+        std::size_t n = block_size - used_;
+        if (n > size)
+          {
+            n = size;
+          }
+        std::memcpy (input_ + used_, p, n);
+        used_ += n;
+        p += n;
+        size -= n;
+        stats_.bytes_in += n;
+
+        if (used_ == block_size)
+          {
+            int err = write_block ();
+            if (err != 0)
+              {
+                return err;
+              }
+          }
+      }
+
+    return 0;
+  }
+
+  int
+  compressed_writer::flush (void) noexcept
+  {
+    if (!file_.is_open ())
+      {
+        return EBADF;
+      }
+    return write_block ();
+  }
+
+  int
+  compressed_writer::write_block (void) noexcept
+  {
+    if (used_ == 0)
+      {
+        return 0;
+      }
+
+    std::size_t length
+        = lz::encode_block (input_, used_, output_, table_, hash_bits);
+    if (length == lz::block_header_size + used_)
+      {
+        ++stats_.stored_blocks;
+      }
+
+    auto res = file_.write (std::span<const std::byte>{
+        reinterpret_cast<const std::byte*> (output_), length });
+    ++stats_.host_writes;
+    if (!res)
+      {
+        // The block is kept, and written again by the next call.
+        return res.error;
+      }
+    stats_.bytes_out += res.count;
+    if (res.count != length)
+      {
+        // The host is out of space; the stream is no longer valid.
+        used_ = 0;
+        return ENOSPC;
+      }
+
+    used_ = 0;
+    return 0;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_COMPRESSED_WRITER)
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
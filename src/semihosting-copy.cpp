@@ -0,0 +1,370 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_COPY)
+
+#include <micro-os-plus/semihosting-copy.h>
+
+#include <cerrno>
+#include <cstring>
+#include <span>
+
+// ----------------------------------------------------------------------------
+
+// The user defined operation (0x100-0x1FF) used to copy on the host;
+// if not defined, the copies are done via SYS_SYSTEM, if enabled,
+// or by the target.
+// #define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COPY_OPERATION (0x102)
+
+// The commands passed to SYS_SYSTEM, for a POSIX shell on the host;
+// the quoted paths are appended, separated by a space, or by `>>`.
+#if !defined(MICRO_OS_PLUS_STRING_SEMIHOSTING_COPY_SYSTEM_COMMAND)
+#define MICRO_OS_PLUS_STRING_SEMIHOSTING_COPY_SYSTEM_COMMAND "cp --"
+#endif
+
+#if !defined(MICRO_OS_PLUS_STRING_SEMIHOSTING_COPY_SYSTEM_APPEND_COMMAND)
+#define MICRO_OS_PLUS_STRING_SEMIHOSTING_COPY_SYSTEM_APPEND_COMMAND "cat --"
+#endif
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus;
+using namespace micro_os_plus::semihosting;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr std::size_t buffer_size
+      = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COPY_BUFFER_ARRAY_SIZE;
+
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COPY_OPERATION)
+
+  int
+  host_error (void)
+  {
+    int err = static_cast<int> (call<SEMIHOSTING_SYS_ERRNO> ());
+    return (err != 0) ? err : EIO;
+  }
+
+  enum copy_form : param_block_t
+  {
+    form_file = 0,
+    form_range = 1,
+  };
+
+  // Set when the host reports that a form is not supported, to avoid
+  // trying again.
+  MICRO_OS_PLUS_SEMIHOSTING_BSS bool is_form_unsupported[2];
+
+  /**
+   * Return true if the host executed the copy, even if it failed.
+   */
+  bool
+  copy_on_host (param_block_t (&fields)[6], copy_result& result)
+  {
+    std::size_t form = static_cast<std::size_t> (fields[0]);
+    if (is_form_unsupported[form])
+      {
+        return false;
+      }
+
+    response_t ret = call_host (
+        MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COPY_OPERATION, fields);
+    if (ret < 0)
+      {
+        int err = host_error ();
+        if (err == ENOSYS)
+          {
+            is_form_unsupported[form] = true;
+            return false;
+          }
+        result = { 0, err, copy_method::host_operation };
+        return true;
+      }
+
+    result
+        = { static_cast<std::size_t> (ret), 0, copy_method::host_operation };
+    return true;
+  }
+
+#endif // defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COPY_OPERATION)
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_COPY_SYSTEM)
+
+  // Set when the host does not execute commands.
+  MICRO_OS_PLUS_SEMIHOSTING_BSS bool is_system_unsupported;
+
+  /**
+   * Append a string to the command; return false if it does not fit.
+   */
+  bool
+  append_to (char* command, std::size_t& length, const char* str,
+             std::size_t size)
+  {
+    if (length + size
+        >= MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COPY_COMMAND_ARRAY_SIZE)
+      {
+        return false;
+      }
+    std::memcpy (command + length, str, size);
+    length += size;
+    return true;
+  }
+
+  bool
+  append_path (char* command, std::size_t& length, host_string path)
+  {
+    const char* data = path.data ();
+    std::size_t size = path.length ();
+
+    // Quotes inside the path would need escaping; leave such paths
+    // to the other methods.
+    if (std::memchr (data, '\'', size) != nullptr)
+      {
+        return false;
+      }
+    return append_to (command, length, " '", 2)
+           && append_to (command, length, data, size)
+           && append_to (command, length, "'", 1);
+  }
+
+  /**
+   * Return 0 if the host command was successful, -1 if the copy must
+   * be done by the target, or the error code.
+   */
+  int
+  copy_with_system (host_string from, host_string to, bool append)
+  {
+    if (is_system_unsupported)
+      {
+        return -1;
+      }
+
+    static constexpr char copy_command[]
+        = MICRO_OS_PLUS_STRING_SEMIHOSTING_COPY_SYSTEM_COMMAND;
+    static constexpr char append_command[]
+        = MICRO_OS_PLUS_STRING_SEMIHOSTING_COPY_SYSTEM_APPEND_COMMAND;
+
+    char command[MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COPY_COMMAND_ARRAY_SIZE];
+    std::size_t length = 0;
+    bool ok = append ? append_to (command, length, append_command,
+                                  sizeof (append_command) - 1)
+                     : append_to (command, length, copy_command,
+                                  sizeof (copy_command) - 1);
+    ok = ok && append_path (command, length, from);
+    if (append)
+      {
+        ok = ok && append_to (command, length, " >>", 3);
+      }
+    ok = ok && append_path (command, length, to);
+    if (!ok)
+      {
+        return -1;
+      }
+    command[length] = '\0';
+
+    response_t ret = call<SEMIHOSTING_SYS_SYSTEM> (
+        host_string{ command, length });
+    if (ret == -1)
+      {
+        is_system_unsupported = true;
+        return -1;
+      }
+    if (ret == 0)
+      {
+        return 0;
+      }
+
+    // The exit status of the command does not tell the reason.
+    // A failed append may have already added part of the data, thus
+    // it is not done again; a failed copy is done again by the
+    // target, which replaces the destination, to get the error code.
+    return append ? EIO : -1;
+  }
+
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_COPY_SYSTEM)
+
+  /**
+   * Copy from the current position of `from` to the current position
+   * of `to`, via a buffer on the stack, until the end of `from`,
+   * or `size` bytes.
+   */
+  copy_result
+  copy_on_target (file& from, file& to, std::size_t size)
+  {
+    std::byte buffer[buffer_size];
+    std::size_t count = 0;
+
+    while (count < size)
+      {
+        std::size_t n = size - count;
+        if (n > buffer_size)
+          {
+            n = buffer_size;
+          }
+
+        auto res = from.read (std::span<std::byte>{ buffer, n });
+        if (!res)
+          {
+            return { count, res.error, copy_method::target };
+          }
+        if (res.count == 0)
+          {
+            // End of file.
+            break;
+          }
+
+        auto written
+            = to.write (std::span<const std::byte>{ buffer, res.count });
+        if (!written)
+          {
+            return { count, written.error, copy_method::target };
+          }
+        count += written.count;
+        if (written.count != res.count)
+          {
+            return { count, ENOSPC, copy_method::target };
+          }
+      }
+
+    return { count, 0, copy_method::target };
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  copy_result
+  copy_file (host_string from, host_string to, bool append) noexcept
+  {
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COPY_OPERATION)
+    {
+      param_block_t fields[6];
+      fields[0] = form_file;
+      fields[1] = detail::to_field (from.data ());
+      fields[2] = from.length ();
+      fields[3] = detail::to_field (to.data ());
+      fields[4] = to.length ();
+      fields[5] = append ? 1 : 0;
+
+      copy_result result;
+      if (copy_on_host (fields, result))
+        {
+          return result;
+        }
+    }
+#endif
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_COPY_SYSTEM)
+    int system_err = copy_with_system (from, to, append);
+    if (system_err >= 0)
+      {
+        return { 0, system_err, copy_method::system };
+      }
+#endif
+
+    file source;
+    int err = source.open (from, open_mode::read_binary);
+    if (err != 0)
+      {
+        return { 0, err, copy_method::target };
+      }
+
+    file destination;
+    err = destination.open (to, append ? open_mode::append_binary
+                                       : open_mode::write_binary);
+    if (err != 0)
+      {
+        return { 0, err, copy_method::target };
+      }
+
+    copy_result result = copy_on_target (source, destination,
+                                         static_cast<std::size_t> (-1));
+
+    err = destination.close ();
+    if (result.error == 0 && err != 0)
+      {
+        result.error = err;
+      }
+
+    return result;
+  }
+
+  copy_result
+  copy_file_range (file& from, std::size_t from_offset, file& to,
+                   std::size_t to_offset, std::size_t size) noexcept
+  {
+    if (!from.is_open () || !to.is_open ())
+      {
+        return { 0, EBADF, copy_method::target };
+      }
+    if (size == 0)
+      {
+        return { 0, 0, copy_method::target };
+      }
+
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_COPY_OPERATION)
+    {
+      param_block_t fields[6];
+      fields[0] = form_range;
+      fields[1] = static_cast<param_block_t> (from.native_handle ());
+      fields[2] = from_offset;
+      fields[3] = static_cast<param_block_t> (to.native_handle ());
+      fields[4] = to_offset;
+      fields[5] = size;
+
+      copy_result result;
+      if (copy_on_host (fields, result))
+        {
+          return result;
+        }
+    }
+#endif
+
+    int err = from.seek (from_offset);
+    if (err == 0)
+      {
+        err = to.seek (to_offset);
+      }
+    if (err != 0)
+      {
+        return { 0, err, copy_method::target };
+      }
+
+    return copy_on_target (from, to, size);
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_COPY)
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,261 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_DATA_LOGGER)
+
+#include <micro-os-plus/semihosting-data-logger.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <span>
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  inline std::atomic_ref<std::uint32_t>
+  shared (std::uint32_t& value)
+  {
+    return std::atomic_ref<std::uint32_t> (value);
+  }
+
+  constexpr std::uint32_t index_shift = 16;
+  constexpr std::uint32_t used_mask = 0xFFFF;
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  data_logger::~data_logger () noexcept
+  {
+    close ();
+  }
+
+  int
+  data_logger::open (host_string path, std::size_t record_size) noexcept
+  {
+    close ();
+
+    if (record_size == 0 || record_size > buffer_size)
+      {
+        return EINVAL;
+      }
+
+    int err = file_.open (path, open_mode::write_binary);
+    if (err != 0)
+      {
+        return err;
+      }
+
+    std::size_t capacity = buffer_size / record_size;
+    record_size_ = record_size;
+    capacity_ = static_cast<std::uint32_t> (
+        (capacity > used_mask) ? used_mask : capacity);
+    head_ = 0;
+    tail_ = 0;
+    for (std::size_t i = 0; i < buffers; ++i)
+      {
+        committed_[i] = 0;
+        // The first buffer is the one being filled.
+        released_[i] = (i == 0) ? 0 : 1;
+      }
+    std::atomic_thread_fence (std::memory_order_release);
+
+    return 0;
+  }
+
+  int
+  data_logger::close (void) noexcept
+  {
+    if (!file_.is_open ())
+      {
+        return 0;
+      }
+
+    int err = drain ();
+
+    // The records in the buffer being filled; the producers are
+    // expected to be stopped.
+    std::uint32_t head = shared (head_).load (std::memory_order_acquire);
+    std::uint32_t index = head >> index_shift;
+    std::uint32_t used = head & used_mask;
+    if (err == 0 && index == tail_ && used > 0 && used < capacity_
+        && shared (committed_[index]).load (std::memory_order_acquire)
+               == used)
+      {
+        err = write_buffer (index, used);
+      }
+
+    int close_err = file_.close ();
+
+    record_size_ = 0;
+    capacity_ = 0;
+
+    return (err != 0) ? err : close_err;
+  }
+
+  bool
+  data_logger::log (const void* record) noexcept
+  {
+    std::uint32_t capacity = capacity_;
+    std::uint32_t head = shared (head_).load (std::memory_order_relaxed);
+    std::uint32_t index;
+    std::uint32_t slot;
+    while (true)
+      {
+        if (capacity == 0)
+          {
+            shared (overruns_).fetch_add (1, std::memory_order_relaxed);
+            return false;
+          }
+
+        std::uint32_t desired;
+        index = head >> index_shift;
+        slot = head & used_mask;
+        if (slot < capacity)
+          {
+            desired = head + 1;
+          }
+        else
+          {
+            // The current buffer is full, continue in the next one,
+            // if it was written to the host. A count of 0 is not
+            // enough, since it also matches a buffer whose records
+            // are reserved but not yet copied; take the released
+            // flag, so only one producer can switch to it.
+            index = (index + 1 == buffers) ? 0 : index + 1;
+            std::uint32_t released = 1;
+            if (!shared (released_[index])
+                     .compare_exchange_strong (released, 0,
+                                               std::memory_order_acquire,
+                                               std::memory_order_relaxed))
+              {
+                shared (overruns_).fetch_add (1, std::memory_order_relaxed);
+                return false;
+              }
+            slot = 0;
+            desired = (index << index_shift) | 1;
+
+            if (shared (head_).compare_exchange_strong (
+                    head, desired, std::memory_order_acquire,
+                    std::memory_order_relaxed))
+              {
+                break;
+              }
+
+            // The head was stale; give the buffer back and retry.
+            shared (released_[index]).store (1, std::memory_order_release);
+            continue;
+          }
+
+        if (shared (head_).compare_exchange_weak (head, desired,
+                                                  std::memory_order_acquire,
+                                                  std::memory_order_relaxed))
+          {
+            break;
+          }
+      }
+
+    std::memcpy (&data_[index][slot * record_size_], record, record_size_);
+    shared (committed_[index]).fetch_add (1, std::memory_order_release);
+
+    return true;
+  }
+
+  int
+  data_logger::drain (void) noexcept
+  {
+    if (!file_.is_open ())
+      {
+        return EBADF;
+      }
+
+    while (shared (committed_[tail_]).load (std::memory_order_acquire)
+           == capacity_)
+      {
+        int err = write_buffer (tail_, capacity_);
+        if (err != 0)
+          {
+            return err;
+          }
+
+        // Release the buffer to the producers.
+        shared (committed_[tail_]).store (0, std::memory_order_relaxed);
+        shared (released_[tail_]).store (1, std::memory_order_release);
+        tail_ = (tail_ + 1 == buffers) ? 0 : tail_ + 1;
+      }
+
+    return 0;
+  }
+
+  data_logger::statistics
+  data_logger::stats (void) const noexcept
+  {
+    return { std::atomic_ref<std::uint32_t> (
+                 const_cast<std::uint32_t&> (overruns_))
+                 .load (std::memory_order_relaxed),
+             host_writes_, bytes_written_ };
+  }
+
+  void
+  data_logger::clear_stats (void) noexcept
+  {
+    shared (overruns_).store (0, std::memory_order_relaxed);
+    host_writes_ = 0;
+    bytes_written_ = 0;
+  }
+
+  int
+  data_logger::write_buffer (std::size_t index, std::size_t count) noexcept
+  {
+    std::size_t length = count * record_size_;
+    auto res
+        = file_.write (std::span<const std::byte>{ data_[index], length });
+    ++host_writes_;
+    if (!res)
+      {
+        return res.error;
+      }
+    bytes_written_ += res.count;
+    if (res.count != length)
+      {
+        // The host is out of space.
+        return ENOSPC;
+      }
+    return 0;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_DATA_LOGGER)
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,149 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_DETACHED_MODE)
+
+#include <micro-os-plus/semihosting.h>
+
+#include <cerrno>
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus;
+
+// ----------------------------------------------------------------------------
+
+/**
+ * This file implements the detached mode, used to run applications
+ * built with semihosting when no debugger is attached.
+ *
+ * Without a debugger, the semihosting traps fault; the architecture
+ * fault handler must call `micro_os_plus_semihosting_fault_hook()`
+ * and, if it returns non zero, skip the trap instruction, as if the
+ * host returned -1.
+ *
+ * The host is probed once, on the first call; after a fault,
+ * `call_host()` no longer traps, so the cost of a fault is paid
+ * only once, and the application can run at full speed.
+ */
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  // Set by the fault hook.
+  MICRO_OS_PLUS_SEMIHOSTING_BSS volatile bool has_faulted;
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  namespace detail
+  {
+    MICRO_OS_PLUS_SEMIHOSTING_BSS host_state state;
+
+    // Called when the state is not `attached`.
+    response_t
+    call_host_not_attached (int reason, param_block_t* arg)
+    {
+      if (state == host_state::unknown)
+        {
+          if (is_host_attached ())
+            {
+              return micro_os_plus_semihosting_call_host (reason, arg);
+            }
+        }
+
+      // Detached, return failure results, or pretend the output
+      // was consumed.
+      switch (reason)
+        {
+        case SEMIHOSTING_SYS_WRITE:
+          // All bytes written.
+          return 0;
+
+        case SEMIHOSTING_SYS_WRITEC:
+        case SEMIHOSTING_SYS_WRITE0:
+          return 0;
+
+        case SEMIHOSTING_SYS_READ:
+          // No bytes read, as at end of file.
+          return static_cast<response_t> (arg[2]);
+
+        case SEMIHOSTING_SYS_ISTTY:
+          return 0;
+
+        case SEMIHOSTING_SYS_ERRNO:
+          return EIO;
+
+        default:
+          return -1;
+        }
+    }
+  } // namespace detail
+
+  // --------------------------------------------------------------------------
+
+  bool
+  is_host_attached (void)
+  {
+    if (detail::state == detail::host_state::unknown)
+      {
+        has_faulted = false;
+
+        // A cheap call, without parameters.
+        micro_os_plus_semihosting_call_host (SEMIHOSTING_SYS_ERRNO, nullptr);
+
+        detail::state = has_faulted ? detail::host_state::detached
+                                    : detail::host_state::attached;
+      }
+
+    return detail::state == detail::host_state::attached;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+int
+micro_os_plus_semihosting_fault_hook (void)
+{
+  has_faulted = true;
+
+  // If the debugger goes away later, stop trapping from now on.
+  semihosting::detail::state = semihosting::detail::host_state::detached;
+
+  return 1;
+}
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_DETACHED_MODE)
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
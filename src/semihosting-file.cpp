@@ -0,0 +1,191 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#include <micro-os-plus/semihosting-file.h>
+
+#include <cerrno>
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  /**
+   * Get the error code from the host, without touching errno;
+   * if the host does not provide one, return a generic I/O error.
+   */
+  int
+  host_error (void)
+  {
+    int err = static_cast<int> (semihosting::call<SEMIHOSTING_SYS_ERRNO> ());
+    return (err != 0) ? err : EIO;
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  file&
+  file::operator= (file&& other) noexcept
+  {
+    if (this != &other)
+      {
+        close ();
+        handle_ = other.handle_;
+        other.handle_ = -1;
+      }
+    return *this;
+  }
+
+  file::~file () noexcept
+  {
+    close ();
+  }
+
+  int
+  file::open (host_string path, open_mode mode) noexcept
+  {
+    close ();
+
+    response_t ret = call<SEMIHOSTING_SYS_OPEN> (path, mode);
+    if (ret < 0)
+      {
+        return host_error ();
+      }
+
+    handle_ = static_cast<int> (ret);
+    return 0;
+  }
+
+  int
+  file::close (void) noexcept
+  {
+    if (handle_ == -1)
+      {
+        return 0;
+      }
+
+    response_t ret = call<SEMIHOSTING_SYS_CLOSE> (handle_);
+
+    // The handle is not usable anymore, even if the host complained.
+    handle_ = -1;
+    if (ret != 0)
+      {
+        return host_error ();
+      }
+
+    return 0;
+  }
+
+  file::result
+  file::read (std::span<std::byte> buffer) noexcept
+  {
+    if (handle_ == -1)
+      {
+        return { 0, EBADF };
+      }
+
+    // Returns the number of bytes *not* read.
+    response_t ret
+        = call<SEMIHOSTING_SYS_READ> (handle_, buffer.data (), buffer.size ());
+    if (ret < 0 || static_cast<std::size_t> (ret) > buffer.size ())
+      {
+        return { 0, host_error () };
+      }
+
+    // Reading nothing is not an error, it means end of file.
+    return { buffer.size () - static_cast<std::size_t> (ret), 0 };
+  }
+
+  file::result
+  file::write (std::span<const std::byte> buffer) noexcept
+  {
+    if (handle_ == -1)
+      {
+        return { 0, EBADF };
+      }
+
+    // Returns the number of bytes *not* written.
+    response_t ret = call<SEMIHOSTING_SYS_WRITE> (handle_, buffer.data (),
+                                                  buffer.size ());
+    // -1 is not a legal value, but SEGGER seems to return it.
+    if (ret < 0 || static_cast<std::size_t> (ret) > buffer.size ())
+      {
+        return { 0, host_error () };
+      }
+
+    std::size_t count = buffer.size () - static_cast<std::size_t> (ret);
+    if (count == 0 && !buffer.empty ())
+      {
+        return { 0, host_error () };
+      }
+
+    return { count, 0 };
+  }
+
+  int
+  file::seek (std::size_t position) noexcept
+  {
+    if (handle_ == -1)
+      {
+        return EBADF;
+      }
+
+    response_t ret = call<SEMIHOSTING_SYS_SEEK> (handle_, position);
+    if (ret < 0)
+      {
+        return host_error ();
+      }
+
+    return 0;
+  }
+
+  file::result
+  file::size (void) noexcept
+  {
+    if (handle_ == -1)
+      {
+        return { 0, EBADF };
+      }
+
+    response_t ret = call<SEMIHOSTING_SYS_FLEN> (handle_);
+    if (ret < 0)
+      {
+        return { 0, host_error () };
+      }
+
+    return { static_cast<std::size_t> (ret), 0 };
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
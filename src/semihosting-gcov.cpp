@@ -0,0 +1,282 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_GCOV)
+
+#include <micro-os-plus/semihosting-gcov.h>
+#include <micro-os-plus/semihosting-file.h>
+
+// The GCC header does not have C++ guards.
+extern "C"
+{
+#include <gcov.h>
+}
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_GCOV_BUFFER_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_GCOV_BUFFER_ARRAY_SIZE (1024)
+#endif
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus;
+
+// ----------------------------------------------------------------------------
+
+extern "C"
+{
+  // Defined in the linker script, around the `.gcov_info` sections.
+  extern const struct gcov_info* const __gcov_info_start[];
+  extern const struct gcov_info* const __gcov_info_end[];
+}
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr std::size_t record_header_size = 1 + 4;
+  constexpr std::size_t no_record = ~static_cast<std::size_t> (0);
+
+  constexpr std::uint8_t record_file_name = 'F';
+  constexpr std::uint8_t record_data = 'D';
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  // The state of the stream, passed to the gcov callbacks.
+  struct stream
+  {
+    semihosting::file f;
+    // The number of bytes in the buffer.
+    std::size_t used;
+    // The offset of the current data record header in the buffer.
+    std::size_t record;
+    // The first error reported by the host; no more writes after it.
+    int error;
+    // Set when an object was skipped; the others are still written.
+    int skip_error;
+    // Set when the data of the current object cannot be stored.
+    bool skip;
+  };
+
+#pragma GCC diagnostic pop
+
+  // Static, the stack during termination might be small.
+  MICRO_OS_PLUS_SEMIHOSTING_BSS std::uint8_t
+      buffer[MICRO_OS_PLUS_INTEGER_SEMIHOSTING_GCOV_BUFFER_ARRAY_SIZE];
+
+  void
+  store_length (std::uint8_t* p, std::size_t length)
+  {
+    // Always little endian, regardless of the target.
+    for (int i = 0; i < 4; ++i)
+      {
+        p[i] = static_cast<std::uint8_t> (length >> (8 * i));
+      }
+  }
+
+  std::uint8_t*
+  open_record (stream* s, std::uint8_t type, std::size_t length)
+  {
+    std::uint8_t* p = &buffer[s->used];
+    p[0] = type;
+    store_length (p + 1, length);
+    s->used += record_header_size;
+    return p + record_header_size;
+  }
+
+  void
+  close_data_record (stream* s)
+  {
+    if (s->record == no_record)
+      {
+        return;
+      }
+
+    std::size_t length = s->used - s->record - record_header_size;
+    if (length == 0)
+      {
+        // Drop empty records.
+        s->used = s->record;
+      }
+    else
+      {
+        store_length (&buffer[s->record + 1], length);
+      }
+    s->record = no_record;
+  }
+
+  void
+  flush (stream* s)
+  {
+    close_data_record (s);
+
+    if (s->used > 0 && s->error == 0)
+      {
+        auto res = s->f.write (
+            { reinterpret_cast<const std::byte*> (buffer), s->used });
+        if (!res)
+          {
+            s->error = res.error;
+          }
+      }
+    s->used = 0;
+  }
+
+  void
+  file_name_callback (const char* name, void* arg)
+  {
+    stream* s = static_cast<stream*> (arg);
+
+    close_data_record (s);
+
+    std::size_t length = (name != nullptr) ? std::strlen (name) : 0;
+    if (record_header_size + length > sizeof (buffer))
+      {
+        s->skip_error = ENAMETOOLONG;
+        s->skip = true;
+        return;
+      }
+
+    s->skip = false;
+
+    if (s->used + record_header_size + length > sizeof (buffer))
+      {
+        flush (s);
+      }
+
+    std::uint8_t* payload = open_record (s, record_file_name, length);
+    if (length > 0)
+      {
+        std::memcpy (payload, name, length);
+        s->used += length;
+      }
+  }
+
+  void
+  dump_callback (const void* data, unsigned length, void* arg)
+  {
+    stream* s = static_cast<stream*> (arg);
+    const std::uint8_t* p = static_cast<const std::uint8_t*> (data);
+
+    if (s->skip)
+      {
+        return;
+      }
+
+    while (length > 0)
+      {
+        if (s->record == no_record)
+          {
+            if (s->used + record_header_size >= sizeof (buffer))
+              {
+                flush (s);
+              }
+            s->record = s->used;
+            // The length is updated when the record is closed.
+            open_record (s, record_data, 0);
+          }
+
+        std::size_t n = sizeof (buffer) - s->used;
+        if (n > length)
+          {
+            n = length;
+          }
+        std::memcpy (&buffer[s->used], p, n);
+        s->used += n;
+        p += n;
+        length -= static_cast<unsigned> (n);
+
+        if (s->used == sizeof (buffer))
+          {
+            flush (s);
+          }
+      }
+  }
+
+  void*
+  allocate_callback (unsigned length, [[maybe_unused]] void* arg)
+  {
+    // Used only for value profiling counters; the application is
+    // terminating, so the memory is never freed.
+    return std::malloc (length);
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting::gcov
+{
+  // --------------------------------------------------------------------------
+
+  int
+  dump (host_string path)
+  {
+    stream s{};
+    s.record = no_record;
+
+    int err = s.f.open (path, open_mode::write_binary);
+    if (err != 0)
+      {
+        return err;
+      }
+
+    std::uint8_t* p = &buffer[0];
+    std::memcpy (p, "SHGC", 4);
+    store_length (p + 4, 1); // Version.
+    s.used = 8;
+
+    for (const struct gcov_info* const* info = __gcov_info_start;
+         info < __gcov_info_end; ++info)
+      {
+        __gcov_info_to_gcda (*info, file_name_callback, dump_callback,
+                             allocate_callback, &s);
+      }
+
+    flush (&s);
+
+    err = s.f.close ();
+    if (s.error != 0)
+      {
+        return s.error;
+      }
+    return (err != 0) ? err : s.skip_error;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::gcov
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_GCOV)
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,476 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_MAILBOX)
+
+#include <micro-os-plus/semihosting.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAILBOX_BUFFER_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAILBOX_BUFFER_ARRAY_SIZE (1024)
+#endif
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus;
+
+// ----------------------------------------------------------------------------
+
+/**
+ * This file implements a transport which passes the semihosting
+ * requests via a ring buffer in RAM, instead of halting the core
+ * with a trap, as long as the host polls the mailbox.
+ *
+ * Each record in the ring has a header with two 32-bit words,
+ * the operation and the payload length, followed by the payload,
+ * padded to 8 bytes; a record never wraps around the end of the ring,
+ * the unused space at the end is filled with a record with the
+ * operation 0, to be skipped by the host.
+ *
+ * Requests which need a response have, as payload, the address of the
+ * parameter block (as passed to the trap); the host executes them as
+ * if they were received via a trap, stores the result in `response`
+ * and increments `response_sequence`, while the caller waits.
+ *
+ * Output requests (`SYS_WRITEC`, `SYS_WRITE0` and `SYS_WRITE` to the
+ * console) are posted, with the data copied in the ring; the caller
+ * does not wait, and the result is always success.
+ *
+ * There can be only one producer; the requests are made with the
+ * interrupts disabled, via `micro_os_plus_semihosting_interrupts_disable()`,
+ * which also covers the wait for the response, like a trap which
+ * halts the core. Multiple cores are not supported.
+ *
+ * If the host stops polling while a request is pending, the record
+ * is cancelled (its operation is cleared, to be skipped if the host
+ * polls again), but the host may have already executed it. The
+ * requests which can be repeated without side effects are then passed
+ * via the trap; the others fail with `EIO`, returned by the next
+ * `SYS_ERRNO`, and their effect is indeterminate (for example a file
+ * may have been opened on the host, or some bytes written).
+ *
+ * Since the requests are synchronous, the expected response sequence
+ * is the one before the request, plus one; this keeps the sequences
+ * in step whether a lost request was executed or not.
+ */
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr std::uint32_t buffer_size
+      = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAILBOX_BUFFER_ARRAY_SIZE;
+
+  static_assert ((buffer_size & (buffer_size - 1)) == 0 && buffer_size >= 64,
+                 "The mailbox buffer size must be a power of 2, at least 64");
+
+  constexpr std::uint32_t header_size = 2 * sizeof (std::uint32_t);
+  constexpr std::uint32_t record_alignment = 8;
+
+  // Large writes are split, to allow the host to consume the ring
+  // while the rest is copied.
+  constexpr std::size_t max_chunk_size
+      = buffer_size / 2 - header_size - sizeof (semihosting::param_block_t);
+
+  MICRO_OS_PLUS_SEMIHOSTING_BSS
+  alignas (record_alignment) std::uint8_t buffer[buffer_size];
+
+  // Set when the host stopped polling with a request pending,
+  // returned instead of the host errno by the next `SYS_ERRNO`.
+  MICRO_OS_PLUS_SEMIHOSTING_BSS int lost_request_errno;
+
+  // The handles obtained by opening ":tt" for writing, also via the
+  // trap, like the standard output opened at startup.
+  MICRO_OS_PLUS_SEMIHOSTING_DATA int console_handles[4] = { -1, -1, -1, -1 };
+
+  inline std::atomic_ref<std::uint32_t>
+  shared (std::uint32_t& value)
+  {
+    return std::atomic_ref<std::uint32_t> (value);
+  }
+
+  /**
+   * Wait for contiguous space in the ring, and return a pointer
+   * to the payload, or `nullptr` if the host stopped polling.
+   */
+  std::uint8_t*
+  reserve (std::size_t length)
+  {
+    auto& mb = micro_os_plus_semihosting_mailbox;
+
+    std::uint32_t total
+        = (header_size + static_cast<std::uint32_t> (length)
+           + record_alignment - 1)
+          & ~(record_alignment - 1);
+
+    // Written only by this producer.
+    std::uint32_t w = mb.write_offset;
+    while (true)
+      {
+        std::uint32_t r
+            = shared (mb.read_offset).load (std::memory_order_acquire);
+        std::uint32_t available = buffer_size - (w - r);
+        std::uint32_t index = w & (buffer_size - 1);
+        std::uint32_t contiguous = buffer_size - index;
+
+        if (contiguous < total)
+          {
+            if (available >= contiguous)
+              {
+                // Skip the end of the ring with a padding record.
+                std::uint32_t header[2] = { 0, contiguous - header_size };
+                std::memcpy (&buffer[index], header, header_size);
+                w += contiguous;
+                shared (mb.write_offset).store (w, std::memory_order_release);
+                continue;
+              }
+          }
+        else if (available >= total)
+          {
+            return &buffer[index + header_size];
+          }
+
+        if (!semihosting::detail::is_mailbox_polled ())
+          {
+            return nullptr;
+          }
+      }
+  }
+
+  /**
+   * Fill in the header and make the record visible to the host.
+   */
+  void
+  commit (std::uint8_t* payload, std::uint32_t operation, std::size_t length)
+  {
+    auto& mb = micro_os_plus_semihosting_mailbox;
+
+    std::uint32_t header[2]
+        = { operation, static_cast<std::uint32_t> (length) };
+    std::memcpy (payload - header_size, header, header_size);
+
+    std::uint32_t total = (header_size + header[1] + record_alignment - 1)
+                          & ~(record_alignment - 1);
+    shared (mb.write_offset)
+        .store (mb.write_offset + total, std::memory_order_release);
+  }
+
+  /**
+   * Turn a committed record into padding, to be skipped by the host.
+   */
+  void
+  cancel (std::uint8_t* payload)
+  {
+    std::uint32_t operation = 0;
+    std::memcpy (payload - header_size, &operation, sizeof (operation));
+    std::atomic_thread_fence (std::memory_order_release);
+  }
+
+  /**
+   * Copy the output in the ring, in chunks, without waiting for the
+   * host to process it.
+   * @return The number of bytes not posted, if the host stopped polling.
+   */
+  std::size_t
+  post (int operation, const semihosting::param_block_t* handle,
+        const void* data, std::size_t length)
+  {
+    const std::uint8_t* p = static_cast<const std::uint8_t*> (data);
+    std::size_t prefix = (handle != nullptr) ? sizeof (*handle) : 0;
+
+    while (length > 0)
+      {
+        std::size_t n = (length > max_chunk_size) ? max_chunk_size : length;
+
+        std::uint8_t* payload = reserve (prefix + n);
+        if (payload == nullptr)
+          {
+            return length;
+          }
+
+        if (handle != nullptr)
+          {
+            std::memcpy (payload, handle, prefix);
+          }
+        std::memcpy (payload + prefix, p, n);
+        commit (payload,
+                static_cast<std::uint32_t> (operation)
+                    | MICRO_OS_PLUS_SEMIHOSTING_MAILBOX_POSTED,
+                prefix + n);
+
+        p += n;
+        length -= n;
+      }
+
+    return 0;
+  }
+
+  bool
+  is_console (int handle)
+  {
+    if (handle < 0)
+      {
+        return false;
+      }
+
+    for (int h : console_handles)
+      {
+        if (h == handle)
+          {
+            return true;
+          }
+      }
+    return false;
+  }
+
+  /**
+   * Tell if the request has no side effects on the host, and can
+   * be executed again if it is not known whether it was executed.
+   */
+  bool
+  is_repeatable (int reason)
+  {
+    switch (reason)
+      {
+      case SEMIHOSTING_SYS_CLOCK:
+      case SEMIHOSTING_SYS_ELAPSED:
+      case SEMIHOSTING_SYS_ERRNO:
+      case SEMIHOSTING_SYS_FLEN:
+      case SEMIHOSTING_SYS_GETCMDLINE:
+      case SEMIHOSTING_SYS_HEAPINFO:
+      case SEMIHOSTING_SYS_ISERROR:
+      case SEMIHOSTING_SYS_ISTTY:
+      case SEMIHOSTING_SYS_SEEK:
+      case SEMIHOSTING_SYS_TICKFREQ:
+      case SEMIHOSTING_SYS_TIME:
+      case SEMIHOSTING_SYS_TMPNAM:
+        return true;
+
+      default:
+        return false;
+      }
+  }
+
+  void
+  update_console_handles (int reason, semihosting::param_block_t* arg,
+                          semihosting::response_t result)
+  {
+    if (reason == SEMIHOSTING_SYS_OPEN && result >= 0)
+      {
+        const char* path = reinterpret_cast<const char*> (arg[0]);
+        if (arg[2] == 3 && std::memcmp (path, ":tt", 3) == 0
+            && arg[1] >= static_cast<semihosting::param_block_t> (
+                   semihosting::open_mode::write))
+          {
+            for (int& h : console_handles)
+              {
+                if (h == -1)
+                  {
+                    h = static_cast<int> (result);
+                    break;
+                  }
+              }
+          }
+      }
+    else if (reason == SEMIHOSTING_SYS_CLOSE && result == 0)
+      {
+        for (int& h : console_handles)
+          {
+            if (h == static_cast<int> (arg[0]))
+              {
+                h = -1;
+              }
+          }
+      }
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+// The host finds the mailbox via this symbol, and checks the id.
+MICRO_OS_PLUS_SEMIHOSTING_DATA
+micro_os_plus_semihosting_mailbox_t micro_os_plus_semihosting_mailbox
+    = { MICRO_OS_PLUS_SEMIHOSTING_MAILBOX_ID,
+        MICRO_OS_PLUS_SEMIHOSTING_MAILBOX_VERSION,
+        buffer_size,
+        0,
+        0,
+        0,
+        0,
+        buffer,
+        0 };
+
+// The offsets expected by the host, for 32 and 64-bit targets.
+static_assert (offsetof (micro_os_plus_semihosting_mailbox_t, buffer) == 40,
+               "Unexpected mailbox layout");
+static_assert (offsetof (micro_os_plus_semihosting_mailbox_t, response)
+                   == 40 + sizeof (void*),
+               "Unexpected mailbox layout");
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting::detail
+{
+  // --------------------------------------------------------------------------
+
+  /**
+   * The mailbox request, with the interrupts disabled.
+   */
+  static response_t
+  call_host_mailbox_locked (int reason, param_block_t* arg)
+  {
+    auto& mb = micro_os_plus_semihosting_mailbox;
+
+    if (reason == SEMIHOSTING_SYS_ERRNO && lost_request_errno != 0)
+      {
+        response_t result = lost_request_errno;
+        lost_request_errno = 0;
+        return result;
+      }
+    // Any other request sets the host errno.
+    lost_request_errno = 0;
+
+    std::size_t not_posted;
+    switch (reason)
+      {
+      case SEMIHOSTING_SYS_WRITEC:
+        not_posted = post (reason, nullptr, arg, 1);
+        if (not_posted == 0)
+          {
+            return 0;
+          }
+        // The host is gone, fall back to the trap.
+        return call_host_trap (reason, arg);
+
+      case SEMIHOSTING_SYS_WRITE0:
+        {
+          const char* str = reinterpret_cast<const char*> (arg);
+          std::size_t length = std::strlen (str);
+          not_posted = post (reason, nullptr, str, length);
+          if (not_posted == 0)
+            {
+              return 0;
+            }
+          return call_host_trap (
+              reason, reinterpret_cast<param_block_t*> (const_cast<char*> (
+                          str + length - not_posted)));
+        }
+
+      case SEMIHOSTING_SYS_WRITE:
+        if (is_console (static_cast<int> (arg[0])))
+          {
+            not_posted = post (reason, &arg[0],
+                               reinterpret_cast<const void*> (arg[1]),
+                               static_cast<std::size_t> (arg[2]));
+            if (not_posted == 0)
+              {
+                // All bytes written.
+                return 0;
+              }
+            param_block_t block[3]
+                = { arg[0], arg[1] + arg[2] - not_posted, not_posted };
+            return call_host_trap (reason, block);
+          }
+        break;
+
+      default:
+        break;
+      }
+
+    response_t result = -1;
+    std::uint8_t* payload = nullptr;
+    if (is_mailbox_polled ())
+      {
+        payload = reserve (sizeof (param_block_t));
+      }
+
+    if (payload == nullptr)
+      {
+        // Not polled (only open, close and errno get here), or the host
+        // stopped polling.
+        result = call_host_trap (reason, arg);
+      }
+    else
+      {
+        std::uint32_t expected
+            = shared (mb.response_sequence).load (std::memory_order_acquire)
+              + 1;
+
+        param_block_t address = reinterpret_cast<param_block_t> (arg);
+        std::memcpy (payload, &address, sizeof (address));
+        commit (payload, static_cast<std::uint32_t> (reason),
+                sizeof (address));
+
+        while (shared (mb.response_sequence).load (std::memory_order_acquire)
+               != expected)
+          {
+            if (!is_mailbox_polled ())
+              {
+                // The host left while the request was pending; it is
+                // not known if the request was executed.
+                cancel (payload);
+                if (is_repeatable (reason))
+                  {
+                    return call_host_trap (reason, arg);
+                  }
+                lost_request_errno = EIO;
+                return -1;
+              }
+          }
+        result = mb.response;
+      }
+
+    update_console_handles (reason, arg, result);
+
+    return result;
+  }
+
+  response_t
+  call_host_mailbox (int reason, param_block_t* arg)
+  {
+    // A single producer; also the requests made by the interrupt
+    // handlers are serialised.
+    uintptr_t status = micro_os_plus_semihosting_interrupts_disable ();
+    response_t result = call_host_mailbox_locked (reason, arg);
+    micro_os_plus_semihosting_interrupts_restore (status);
+
+    return result;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::detail
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_MAILBOX)
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,355 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_METRICS)
+
+#include <micro-os-plus/semihosting-metrics.h>
+#include <micro-os-plus/semihosting-file.h>
+
+#include <cerrno>
+#include <cstring>
+#include <span>
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus;
+
+// ----------------------------------------------------------------------------
+
+/**
+ * The stream layout; all multi-byte values are LEB128 varints, so the
+ * stream does not depend on the target byte order:
+ *
+ * char magic[4]        "SHMT"
+ * uint8 version        1
+ * uint8 count          the number of metrics
+ * for each metric:
+ *   uint8 type         0 counter, 1 gauge
+ *   uint8 length
+ *   char name[length]
+ * for each sample:
+ *   varint             timestamp - previous timestamp, modulo 2^32
+ *   uint8 changed[(count + 7) / 8], one bit per metric, LSB first
+ *   for each changed metric:
+ *     varint           zigzag (value - previous value), modulo 2^32
+ *
+ * The previous values are 0 before the first sample.
+ */
+
+namespace
+{
+  constexpr char magic[4] = { 'S', 'H', 'M', 'T' };
+  constexpr std::uint8_t version = 1;
+
+  constexpr std::size_t buffer_size
+      = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_METRICS_BUFFER_SIZE;
+
+  // A 32-bit varint takes at most 5 bytes.
+  constexpr std::size_t max_varint_size = 5;
+
+  constexpr std::size_t
+  record_size (std::size_t count)
+  {
+    return max_varint_size + (count + 7) / 8 + count * max_varint_size;
+  }
+
+  static_assert (buffer_size >= record_size (semihosting::metrics::max_metrics)
+                     && buffer_size >= 2 + 255,
+                 "The metrics buffer is too small for a record");
+
+  MICRO_OS_PLUS_SEMIHOSTING_BSS semihosting::metrics::metric*
+      registry[semihosting::metrics::max_metrics];
+  MICRO_OS_PLUS_SEMIHOSTING_BSS std::size_t registered_count;
+
+  MICRO_OS_PLUS_SEMIHOSTING_DATA semihosting::file stream;
+  // The number of metrics in the current stream.
+  MICRO_OS_PLUS_SEMIHOSTING_BSS std::size_t columns;
+  MICRO_OS_PLUS_SEMIHOSTING_BSS std::uint32_t previous_timestamp;
+  MICRO_OS_PLUS_SEMIHOSTING_BSS
+  std::uint32_t previous[semihosting::metrics::max_metrics];
+
+  MICRO_OS_PLUS_SEMIHOSTING_BSS std::size_t used;
+  MICRO_OS_PLUS_SEMIHOSTING_BSS std::uint8_t buffer[buffer_size];
+
+  MICRO_OS_PLUS_SEMIHOSTING_BSS semihosting::metrics::statistics counters;
+
+  std::uint8_t*
+  put_varint (std::uint8_t* p, std::uint32_t value)
+  {
+    while (value >= 0x80)
+      {
+        *p++ = static_cast<std::uint8_t> (value | 0x80);
+        value >>= 7;
+      }
+    *p++ = static_cast<std::uint8_t> (value);
+    return p;
+  }
+
+  // Map small negative differences to small numbers.
+  std::uint32_t
+  zigzag (std::uint32_t delta)
+  {
+    return (delta << 1) ^ ((delta & 0x80000000) ? 0xFFFFFFFF : 0);
+  }
+
+  /**
+   * Write the buffer to the host; after a short write, the rest is
+   * kept, to be written by the next call, so the stream remains
+   * consistent.
+   */
+  int
+  write_buffer (void)
+  {
+    if (used == 0)
+      {
+        return 0;
+      }
+
+    auto res = stream.write (
+        std::span<const std::byte>{ reinterpret_cast<std::byte*> (buffer),
+                                    used });
+    ++counters.host_writes;
+    if (!res)
+      {
+        return res.error;
+      }
+
+    counters.bytes_written += res.count;
+    if (res.count != used)
+      {
+        std::memmove (buffer, buffer + res.count, used - res.count);
+        used -= res.count;
+        // The host is out of space.
+        return ENOSPC;
+      }
+
+    used = 0;
+    return 0;
+  }
+
+  // Make room for the given number of bytes.
+  int
+  reserve (std::size_t size)
+  {
+    if (used + size > buffer_size)
+      {
+        int err = write_buffer ();
+        if (err != 0 || used + size > buffer_size)
+          {
+            return (err != 0) ? err : ENOSPC;
+          }
+      }
+    return 0;
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting::metrics
+{
+  // --------------------------------------------------------------------------
+
+  metric::metric (const char* name, type kind,
+                  std::int32_t (*read) (void)) noexcept
+      : name_{ name },
+        read_{ read },
+        kind_{ kind }
+  {
+    // While a stream is started, the index is its column; the places
+    // of the destroyed metrics are reclaimed by the next `start()`.
+    if (registered_count < max_metrics)
+      {
+        registry[registered_count++] = this;
+        registered_ = true;
+      }
+  }
+
+  metric::~metric () noexcept
+  {
+    // The column remains in the stream, with the last value.
+    for (std::size_t i = 0; i < registered_count; ++i)
+      {
+        if (registry[i] == this)
+          {
+            registry[i] = nullptr;
+          }
+      }
+  }
+
+  int
+  start (host_string path) noexcept
+  {
+    stop ();
+
+    int err = stream.open (path, open_mode::write_binary);
+    if (err != 0)
+      {
+        return err;
+      }
+
+    // Remove the places of the destroyed metrics; the indices change,
+    // but no stream is using them.
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < registered_count; ++i)
+      {
+        if (registry[i] != nullptr)
+          {
+            registry[count++] = registry[i];
+          }
+      }
+    registered_count = count;
+
+    columns = registered_count;
+    previous_timestamp = 0;
+    std::memset (previous, 0, sizeof (previous));
+    used = 0;
+    counters = {};
+
+    std::memcpy (buffer, magic, sizeof (magic));
+    buffer[4] = version;
+    buffer[5] = static_cast<std::uint8_t> (columns);
+    used = 6;
+
+    for (std::size_t i = 0; i < columns; ++i)
+      {
+        const char* name = registry[i]->name ();
+        std::size_t length = std::strlen (name);
+        if (length > 255)
+          {
+            length = 255;
+          }
+
+        err = reserve (2 + length);
+        if (err != 0)
+          {
+            stream.close ();
+            return err;
+          }
+        buffer[used++] = static_cast<std::uint8_t> (registry[i]->kind ());
+        buffer[used++] = static_cast<std::uint8_t> (length);
+        std::memcpy (buffer + used, name, length);
+        used += length;
+      }
+
+    return 0;
+  }
+
+  int
+  sample (std::uint32_t timestamp) noexcept
+  {
+    if (!stream.is_open ())
+      {
+        return EBADF;
+      }
+
+    int err = reserve (record_size (columns));
+    if (err != 0)
+      {
+        // The previous values are not updated, the next record
+        // continues from the last stored one.
+        ++counters.dropped;
+        return err;
+      }
+
+    std::uint8_t* p = put_varint (buffer + used,
+                                  timestamp - previous_timestamp);
+    previous_timestamp = timestamp;
+
+    std::uint8_t* changed = p;
+    std::size_t changed_size = (columns + 7) / 8;
+    std::memset (changed, 0, changed_size);
+    p += changed_size;
+
+    for (std::size_t i = 0; i < columns; ++i)
+      {
+        if (registry[i] == nullptr)
+          {
+            continue;
+          }
+        std::uint32_t value = registry[i]->value ();
+        if (value != previous[i])
+          {
+            changed[i / 8] |= static_cast<std::uint8_t> (1u << (i % 8));
+            p = put_varint (p, zigzag (value - previous[i]));
+            previous[i] = value;
+          }
+      }
+
+    used = static_cast<std::size_t> (p - buffer);
+    ++counters.samples;
+
+    // Write as soon as another record may not fit.
+    if (used + record_size (columns) > buffer_size)
+      {
+        return write_buffer ();
+      }
+    return 0;
+  }
+
+  int
+  flush (void) noexcept
+  {
+    if (!stream.is_open ())
+      {
+        return EBADF;
+      }
+    return write_buffer ();
+  }
+
+  int
+  stop (void) noexcept
+  {
+    if (!stream.is_open ())
+      {
+        return 0;
+      }
+
+    int err = write_buffer ();
+    int close_err = stream.close ();
+    used = 0;
+
+    return (err != 0) ? err : close_err;
+  }
+
+  bool
+  is_started (void) noexcept
+  {
+    return stream.is_open ();
+  }
+
+  statistics
+  stats (void) noexcept
+  {
+    return counters;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::metrics
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_METRICS)
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
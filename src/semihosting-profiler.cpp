@@ -0,0 +1,266 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_PROFILER)
+
+#include <micro-os-plus/semihosting-profiler.h>
+#include <micro-os-plus/semihosting-file.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_PROFILER_HISTOGRAM_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_PROFILER_HISTOGRAM_ARRAY_SIZE (1024)
+#endif
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  // The GNU gmon.out layout (see gmon_out.h in binutils); all multi-byte
+  // values are in the target byte order, as expected by gprof.
+  //
+  // struct gmon_hdr
+  // {
+  //   char cookie[4]; // "gmon"
+  //   char version[4]; // 1
+  //   char spare[3 * 4];
+  // };
+  //
+  // char tag; // GMON_TAG_TIME_HIST
+  //
+  // struct gmon_hist_hdr
+  // {
+  //   char low_pc[sizeof (char*)];
+  //   char high_pc[sizeof (char*)];
+  //   char hist_size[4]; // number of histogram bins
+  //   char prof_rate[4]; // samples per second
+  //   char dimen[15]; // "seconds"
+  //   char dimen_abbrev; // 's'
+  // };
+  //
+  // std::uint16_t bins[hist_size];
+
+  constexpr std::size_t gmon_hdr_size = 4 + 4 + 3 * 4;
+  constexpr std::size_t gmon_hist_hdr_size
+      = 2 * sizeof (std::uintptr_t) + 4 + 4 + 15 + 1;
+  constexpr std::size_t header_size = gmon_hdr_size + 1 + gmon_hist_hdr_size;
+
+  constexpr std::uint8_t gmon_tag_time_hist = 0;
+
+  constexpr std::size_t bins_count
+      = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_PROFILER_HISTOGRAM_ARRAY_SIZE;
+
+  // The header is stored just before the bins, so the entire file
+  // can be sent to the host with a single write.
+  constexpr std::size_t header_room
+      = (header_size + sizeof (std::uint16_t) - 1)
+        & ~(sizeof (std::uint16_t) - 1);
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  struct gmon_image
+  {
+    std::uint8_t header[header_room];
+    std::uint16_t bins[bins_count];
+  };
+
+#pragma GCC diagnostic pop
+
+  static_assert (offsetof (gmon_image, bins) == header_room,
+                 "The bins must follow the header without padding");
+
+  MICRO_OS_PLUS_SEMIHOSTING_BSS gmon_image image;
+
+  MICRO_OS_PLUS_SEMIHOSTING_BSS std::uintptr_t low_pc;
+  MICRO_OS_PLUS_SEMIHOSTING_BSS std::uintptr_t high_pc;
+  MICRO_OS_PLUS_SEMIHOSTING_BSS unsigned int bucket_shift;
+  MICRO_OS_PLUS_SEMIHOSTING_BSS std::uint32_t sampling_frequency;
+  MICRO_OS_PLUS_SEMIHOSTING_BSS std::size_t missed;
+
+  MICRO_OS_PLUS_SEMIHOSTING_BSS std::atomic<bool> is_sampling;
+
+  std::uint8_t*
+  store (std::uint8_t* p, const void* value, std::size_t size)
+  {
+    std::memcpy (p, value, size);
+    return p + size;
+  }
+
+  void
+  fill_header (void)
+  {
+    std::uint8_t* p = &image.header[header_room - header_size];
+
+    p = store (p, "gmon", 4);
+    std::int32_t version = 1;
+    p = store (p, &version, 4);
+    std::memset (p, 0, 3 * 4);
+    p += 3 * 4;
+
+    *p++ = gmon_tag_time_hist;
+
+    p = store (p, &low_pc, sizeof (low_pc));
+    p = store (p, &high_pc, sizeof (high_pc));
+    std::int32_t hist_size = static_cast<std::int32_t> (bins_count);
+    p = store (p, &hist_size, 4);
+    std::int32_t prof_rate = static_cast<std::int32_t> (sampling_frequency);
+    p = store (p, &prof_rate, 4);
+    char dimen[15] = "seconds";
+    p = store (p, dimen, sizeof (dimen));
+    *p = 's';
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting::profiler
+{
+  // --------------------------------------------------------------------------
+
+  int
+  start (std::uintptr_t low, std::uintptr_t high,
+         std::uint32_t sampling_frequency_hz)
+  {
+    is_sampling.store (false);
+
+    unsigned int shift = 0;
+    if (high > low)
+      {
+        while (((high - low - 1) >> shift) >= bins_count)
+          {
+            ++shift;
+          }
+      }
+
+    // Round the range up to the end of the last bucket, as expected
+    // by gprof, which computes the bucket size from it; the end must
+    // be representable.
+    std::uintptr_t span = static_cast<std::uintptr_t> (bins_count) << shift;
+    if ((span >> shift) != bins_count || span > UINTPTR_MAX - low)
+      {
+        return EINVAL;
+      }
+
+    bucket_shift = shift;
+    low_pc = low;
+    high_pc = low + span;
+    sampling_frequency = sampling_frequency_hz;
+    missed = 0;
+
+    std::memset (image.bins, 0, sizeof (image.bins));
+
+    is_sampling.store (true);
+
+    return 0;
+  }
+
+  void
+  stop (void)
+  {
+    is_sampling.store (false);
+  }
+
+  void
+  sample (std::uintptr_t pc)
+  {
+    if (!is_sampling.load (std::memory_order_relaxed))
+      {
+        return;
+      }
+
+    if (pc < low_pc || pc >= high_pc)
+      {
+        ++missed;
+        return;
+      }
+
+    std::uint16_t* bin = &image.bins[(pc - low_pc) >> bucket_shift];
+    // Saturate, do not wrap around.
+    if (*bin != UINT16_MAX)
+      {
+        ++*bin;
+      }
+  }
+
+  std::size_t
+  missed_samples (void)
+  {
+    return missed;
+  }
+
+  int
+  write (host_string path)
+  {
+    stop ();
+    if (sampling_frequency == 0)
+      {
+        // Never started, nothing to write.
+        return EINVAL;
+      }
+
+    fill_header ();
+
+    file f;
+    int err = f.open (path, open_mode::write_binary);
+    if (err != 0)
+      {
+        return err;
+      }
+
+    const std::byte* data = reinterpret_cast<const std::byte*> (
+        &image.header[header_room - header_size]);
+    std::size_t size = header_size + sizeof (image.bins);
+    auto res = f.write ({ data, size });
+    if (!res)
+      {
+        return res.error;
+      }
+    if (res.count != size)
+      {
+        // The host is out of space.
+        return ENOSPC;
+      }
+
+    return f.close ();
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::profiler
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_PROFILER)
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
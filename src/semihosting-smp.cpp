@@ -0,0 +1,234 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SMP) \
+    || defined(MICRO_OS_PLUS_USE_SEMIHOSTING_MAILBOX)
+
+#include <micro-os-plus/semihosting.h>
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SMP)
+#include <micro-os-plus/semihosting-smp.h>
+#endif
+
+#include <atomic>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SMP)
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_SMP_CORES_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_SMP_CORES_ARRAY_SIZE (2)
+#endif
+
+// The number of requests a core can have pending at the same time,
+// from different threads or interrupts.
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_SMP_QUEUE_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_SMP_QUEUE_ARRAY_SIZE (4)
+#endif
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  struct target_platform
+  {
+    using response_type = semihosting::response_t;
+    using argument_type = semihosting::param_block_t*;
+    using interrupts_status_type = std::uintptr_t;
+
+    static std::size_t
+    core_id (void) noexcept
+    {
+      return micro_os_plus_semihosting_smp_core_id ();
+    }
+
+    static response_type
+    trap (int reason, argument_type arg) noexcept
+    {
+      return micro_os_plus_semihosting_call_host (reason, arg);
+    }
+
+    static void
+    wait (const std::uint32_t* address, std::uint32_t value) noexcept
+    {
+      micro_os_plus_semihosting_smp_wait (address, value);
+    }
+
+    static void
+    notify (const std::uint32_t* address) noexcept
+    {
+      micro_os_plus_semihosting_smp_notify (address);
+    }
+
+    static interrupts_status_type
+    interrupts_disable (void) noexcept
+    {
+      return micro_os_plus_semihosting_interrupts_disable ();
+    }
+
+    static void
+    interrupts_restore (interrupts_status_type status) noexcept
+    {
+      micro_os_plus_semihosting_interrupts_restore (status);
+    }
+  };
+
+  // Constant initialised, usable before the static constructors.
+  MICRO_OS_PLUS_SEMIHOSTING_BSS constinit semihosting::smp::serialiser<
+      target_platform, MICRO_OS_PLUS_INTEGER_SEMIHOSTING_SMP_CORES_ARRAY_SIZE,
+      MICRO_OS_PLUS_INTEGER_SEMIHOSTING_SMP_QUEUE_ARRAY_SIZE>
+      serialiser;
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+unsigned int __attribute__ ((weak))
+micro_os_plus_semihosting_smp_core_id (void)
+{
+#if defined(__aarch64__)
+  std::uint64_t mpidr;
+  asm volatile("mrs %0, mpidr_el1" : "=r"(mpidr));
+  return static_cast<unsigned int> (mpidr & 0xFF);
+#elif defined(__ARM_ARCH_PROFILE) \
+    && (__ARM_ARCH_PROFILE == 'A' || __ARM_ARCH_PROFILE == 'R')
+  std::uint32_t mpidr;
+  asm volatile("mrc p15, 0, %0, c0, c0, 5" : "=r"(mpidr));
+  return mpidr & 0xFF;
+#elif defined(__riscv)
+  unsigned long hart;
+  asm volatile("csrr %0, mhartid" : "=r"(hart));
+  return static_cast<unsigned int> (hart);
+#else
+  return 0;
+#endif
+}
+
+void __attribute__ ((weak))
+micro_os_plus_semihosting_smp_wait (const uint32_t* address, uint32_t value)
+{
+  if (std::atomic_ref<std::uint32_t> (*const_cast<std::uint32_t*> (address))
+          .load (std::memory_order_acquire)
+      != value)
+    {
+      return;
+    }
+#if defined(__aarch64__) \
+    || (defined(__ARM_ARCH_PROFILE) \
+        && (__ARM_ARCH_PROFILE == 'A' || __ARM_ARCH_PROFILE == 'R'))
+  // A `SEV` since the last `WFE` makes it return immediately, so the
+  // wake-up between the check and the sleep is not lost.
+  asm volatile("wfe" ::: "memory");
+#elif defined(__riscv)
+  // There is no `SEV` to pair with `wfi`, and a `wfi` without an
+  // interrupt may never return, so this only spins; the application
+  // must redefine the wait and the notify to sleep (see the header).
+  // The `pause` hint (Zihintpause), encoded as `fence w, 0`, is a
+  // `nop` on cores without it.
+  asm volatile(".insn i 0x0F, 0, x0, x0, 0x010" ::: "memory");
+#endif
+}
+
+void __attribute__ ((weak))
+micro_os_plus_semihosting_smp_notify (const uint32_t* address
+                                      __attribute__ ((unused)))
+{
+#if defined(__aarch64__)
+  asm volatile("dsb ish\n\tsev" ::: "memory");
+#elif defined(__ARM_ARCH_PROFILE) \
+    && (__ARM_ARCH_PROFILE == 'A' || __ARM_ARCH_PROFILE == 'R')
+  asm volatile("dsb\n\tsev" ::: "memory");
+#endif
+}
+
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SMP)
+
+// ----------------------------------------------------------------------------
+
+// Also used by the mailbox transport.
+uintptr_t __attribute__ ((weak))
+micro_os_plus_semihosting_interrupts_disable (void)
+{
+  uintptr_t status = 0;
+#if defined(__aarch64__)
+  asm volatile("mrs %0, daif\n\tmsr daifset, #3"
+               : "=r"(status)::"memory");
+#elif defined(__ARM_ARCH_PROFILE) && (__ARM_ARCH_PROFILE == 'M')
+  asm volatile("mrs %0, primask\n\tcpsid i" : "=r"(status)::"memory");
+#elif defined(__ARM_ARCH_PROFILE) \
+    && (__ARM_ARCH_PROFILE == 'A' || __ARM_ARCH_PROFILE == 'R')
+  asm volatile("mrs %0, cpsr\n\tcpsid if" : "=r"(status)::"memory");
+#elif defined(__riscv)
+  // Clear mstatus.MIE, and keep its previous value.
+  asm volatile("csrrci %0, mstatus, 8" : "=r"(status)::"memory");
+#endif
+  return status;
+}
+
+void __attribute__ ((weak))
+micro_os_plus_semihosting_interrupts_restore (uintptr_t status)
+{
+#if defined(__aarch64__)
+  asm volatile("msr daif, %0" ::"r"(status) : "memory");
+#elif defined(__ARM_ARCH_PROFILE) && (__ARM_ARCH_PROFILE == 'M')
+  asm volatile("msr primask, %0" ::"r"(status) : "memory");
+#elif defined(__ARM_ARCH_PROFILE) \
+    && (__ARM_ARCH_PROFILE == 'A' || __ARM_ARCH_PROFILE == 'R')
+  asm volatile("msr cpsr_c, %0" ::"r"(status) : "memory");
+#elif defined(__riscv)
+  asm volatile("csrs mstatus, %0" ::"r"(status & 8) : "memory");
+#else
+  static_cast<void> (status);
+#endif
+}
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SMP)
+
+namespace micro_os_plus::semihosting::detail
+{
+  // --------------------------------------------------------------------------
+
+  response_t
+  call_host_smp (int reason, param_block_t* arg)
+  {
+    return serialiser.call (reason, arg);
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::detail
+
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SMP)
+
+// ----------------------------------------------------------------------------
+
+#endif // SMP || MAILBOX
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
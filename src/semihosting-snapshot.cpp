@@ -0,0 +1,347 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_SNAPSHOT)
+
+#include <micro-os-plus/semihosting-snapshot.h>
+#include <micro-os-plus/semihosting-file.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+extern "C"
+{
+  // Defined by the linker script around the sections of this package,
+  // if grouped; otherwise null.
+  extern char __semihosting_data_start__[] __attribute__ ((weak));
+  extern char __semihosting_data_end__[] __attribute__ ((weak));
+  extern char __semihosting_bss_start__[] __attribute__ ((weak));
+  extern char __semihosting_bss_end__[] __attribute__ ((weak));
+}
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus;
+
+// ----------------------------------------------------------------------------
+
+/**
+ * The snapshot file layout, in the target byte order:
+ *  0  char magic[8]       "SNAPSHOT"
+ *  8  uint32 version      1
+ * 12  uint32 regions
+ * 16  uint32 key_size
+ * 20  uint32 reserved
+ * 24  the key, padded to 8 bytes
+ *     for each region, uint64 address and uint64 size
+ *     the contents of each region
+ */
+
+namespace
+{
+  constexpr char magic[8] = { 'S', 'N', 'A', 'P', 'S', 'H', 'O', 'T' };
+  constexpr std::uint32_t version = 1;
+
+  struct header
+  {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t regions;
+    std::uint32_t key_size;
+    std::uint32_t reserved;
+  };
+
+  struct region_entry
+  {
+    std::uint64_t address;
+    std::uint64_t size;
+  };
+
+  constexpr std::size_t padded (std::size_t size)
+  {
+    return (size + 7) & ~static_cast<std::size_t> (7);
+  }
+
+  // The variable part of the header, the key and the regions table.
+  constexpr std::size_t table_buffer_size
+      = padded (semihosting::snapshot::max_key_size)
+        + semihosting::snapshot::max_regions * sizeof (region_entry);
+
+  /**
+   * Fill in the key and the regions table, and return its length,
+   * or 0 if the arguments are not valid.
+   */
+  std::size_t
+  make_table (std::byte* buffer,
+              std::span<const semihosting::snapshot::region> regions,
+              std::span<const std::byte> key)
+  {
+    if (regions.empty ()
+        || regions.size () > semihosting::snapshot::max_regions
+        || key.size () > semihosting::snapshot::max_key_size)
+      {
+        return 0;
+      }
+
+    std::memset (buffer, 0, padded (key.size ()));
+    std::memcpy (buffer, key.data (), key.size ());
+
+    std::byte* p = buffer + padded (key.size ());
+    for (const auto& r : regions)
+      {
+        region_entry entry
+            = { reinterpret_cast<std::uintptr_t> (r.address), r.size };
+        std::memcpy (p, &entry, sizeof (entry));
+        p += sizeof (entry);
+      }
+
+    return static_cast<std::size_t> (p - buffer);
+  }
+
+  int
+  write_all (semihosting::file& f, const void* data, std::size_t size)
+  {
+    auto res = f.write (std::span<const std::byte>{
+        static_cast<const std::byte*> (data), size });
+    if (!res)
+      {
+        return res.error;
+      }
+    return (res.count == size) ? 0 : ENOSPC;
+  }
+
+  int
+  read_all (semihosting::file& f, void* data, std::size_t size)
+  {
+    auto res = f.read (
+        std::span<std::byte>{ static_cast<std::byte*> (data), size });
+    if (!res)
+      {
+        return res.error;
+      }
+    return (res.count == size) ? 0 : ESTALE;
+  }
+
+  struct address_range
+  {
+    std::uintptr_t begin;
+    std::uintptr_t end;
+  };
+
+  /**
+   * Read a region, except the parts with the variables of this
+   * package (the file descriptors, the arguments, the trace and the
+   * mailbox state), which are kept as they are in the current run;
+   * these parts are skipped in the file.
+   */
+  int
+  read_region (semihosting::file& f, std::size_t offset,
+               const semihosting::snapshot::region& r)
+  {
+    const address_range kept[] = {
+      { reinterpret_cast<std::uintptr_t> (__semihosting_data_start__),
+        reinterpret_cast<std::uintptr_t> (__semihosting_data_end__) },
+      { reinterpret_cast<std::uintptr_t> (__semihosting_bss_start__),
+        reinterpret_cast<std::uintptr_t> (__semihosting_bss_end__) },
+    };
+
+    std::uintptr_t begin = reinterpret_cast<std::uintptr_t> (r.address);
+    std::uintptr_t end = begin + r.size;
+    std::uintptr_t p = begin;
+    while (p < end)
+      {
+        // The first kept range which is not before p.
+        address_range next = { end, end };
+        for (const auto& k : kept)
+          {
+            if (k.begin < k.end && k.end > p && k.begin < next.begin)
+              {
+                next = { (k.begin > p) ? k.begin : p,
+                         (k.end < end) ? k.end : end };
+              }
+          }
+
+        if (next.begin > p)
+          {
+            int err = read_all (f, reinterpret_cast<void*> (p),
+                                next.begin - p);
+            if (err != 0)
+              {
+                return err;
+              }
+          }
+        if (next.end > next.begin)
+          {
+            int err = f.seek (offset + (next.end - begin));
+            if (err != 0)
+              {
+                return err;
+              }
+          }
+        p = next.end;
+      }
+
+    return 0;
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+void __attribute__ ((weak))
+micro_os_plus_semihosting_snapshot_startup (int argc __attribute__ ((unused)),
+                                            char* argv[]
+                                            __attribute__ ((unused)))
+{
+}
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting::snapshot
+{
+  // --------------------------------------------------------------------------
+
+  int
+  save (host_string path, std::span<const region> regions,
+        std::span<const std::byte> key) noexcept
+  {
+    alignas (8) std::byte buffer[sizeof (header) + table_buffer_size];
+
+    std::size_t table_size
+        = make_table (buffer + sizeof (header), regions, key);
+    if (table_size == 0)
+      {
+        return EINVAL;
+      }
+
+    header h{};
+    std::memcpy (h.magic, magic, sizeof (magic));
+    h.version = version;
+    h.regions = static_cast<std::uint32_t> (regions.size ());
+    h.key_size = static_cast<std::uint32_t> (key.size ());
+    std::memcpy (buffer, &h, sizeof (h));
+
+    file f;
+    int err = f.open (path, open_mode::write_binary);
+    if (err != 0)
+      {
+        return err;
+      }
+
+    // The header and the table in a single write, then each region.
+    err = write_all (f, buffer, sizeof (header) + table_size);
+    for (std::size_t i = 0; err == 0 && i < regions.size (); ++i)
+      {
+        err = write_all (f, regions[i].address, regions[i].size);
+      }
+
+    int close_err = f.close ();
+    return (err != 0) ? err : close_err;
+  }
+
+  int
+  restore (host_string path, std::span<const region> regions,
+           std::span<const std::byte> key) noexcept
+  {
+    alignas (8) std::byte expected[table_buffer_size];
+    alignas (8) std::byte actual[table_buffer_size];
+
+    std::size_t table_size = make_table (expected, regions, key);
+    if (table_size == 0)
+      {
+        return EINVAL;
+      }
+
+    std::size_t total_size = sizeof (header) + table_size;
+    for (const auto& r : regions)
+      {
+        total_size += r.size;
+      }
+
+    file f;
+    int err = f.open (path, open_mode::read_binary);
+    if (err != 0)
+      {
+        return err;
+      }
+
+    // Validate everything before changing the memory.
+    auto length = f.size ();
+    if (!length)
+      {
+        return length.error;
+      }
+    if (length.count != total_size)
+      {
+        return ESTALE;
+      }
+
+    header h;
+    err = read_all (f, &h, sizeof (h));
+    if (err != 0)
+      {
+        return err;
+      }
+    if (std::memcmp (h.magic, magic, sizeof (magic)) != 0
+        || h.version != version || h.regions != regions.size ()
+        || h.key_size != key.size ())
+      {
+        return ESTALE;
+      }
+
+    err = read_all (f, actual, table_size);
+    if (err != 0)
+      {
+        return err;
+      }
+    if (std::memcmp (actual, expected, table_size) != 0)
+      {
+        return ESTALE;
+      }
+
+    std::size_t offset = sizeof (header) + table_size;
+    for (const auto& r : regions)
+      {
+        err = read_region (f, offset, r);
+        if (err != 0)
+          {
+            return err;
+          }
+        offset += r.size;
+      }
+
+    return f.close ();
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::snapshot
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_SNAPSHOT)
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
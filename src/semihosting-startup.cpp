@@ -25,6 +25,30 @@
 #include <micro-os-plus/architecture.h>
 #include <micro-os-plus/diag/trace.h>
 
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_PROFILER)
+#include <micro-os-plus/semihosting-profiler.h>
+#endif
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_GCOV)
+#include <micro-os-plus/semihosting-gcov.h>
+#endif
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BOOT_PROFILER)
+#include <micro-os-plus/semihosting-boot-profiler.h>
+#endif
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_METRICS)
+#include <micro-os-plus/semihosting-metrics.h>
+#endif
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_SNAPSHOT)
+#include <micro-os-plus/semihosting-snapshot.h>
+#endif
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TRANSPORT_COST)
+#include <micro-os-plus/semihosting-transport-cost.h>
+#endif
+
 #include <ctype.h>
 
 // ----------------------------------------------------------------------------
@@ -37,6 +61,14 @@
 #define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_ARGV_ARRAY_SIZE 10
 #endif
 
+#if !defined(MICRO_OS_PLUS_STRING_SEMIHOSTING_PROFILER_FILE_NAME)
+#define MICRO_OS_PLUS_STRING_SEMIHOSTING_PROFILER_FILE_NAME "gmon.out"
+#endif
+
+#if !defined(MICRO_OS_PLUS_STRING_SEMIHOSTING_GCOV_FILE_NAME)
+#define MICRO_OS_PLUS_STRING_SEMIHOSTING_GCOV_FILE_NAME "gcda.stream"
+#endif
+
 // ----------------------------------------------------------------------------
 
 using namespace micro_os_plus;
@@ -63,28 +95,33 @@ void
 micro_os_plus_startup_initialize_args (int* p_argc, char*** p_argv)
 {
   // Array of chars to receive the command line from the host.
-  static char cmdline[MICRO_OS_PLUS_INTEGER_SEMIHOSTING_CMDLINE_ARRAY_SIZE];
+  static MICRO_OS_PLUS_SEMIHOSTING_BSS char
+      cmdline[MICRO_OS_PLUS_INTEGER_SEMIHOSTING_CMDLINE_ARRAY_SIZE];
 
   // Array of pointers to store the final argv pointers (pointing
   // in the cmdline array).
-  static char* argv[MICRO_OS_PLUS_INTEGER_SEMIHOSTING_ARGV_ARRAY_SIZE];
+  static MICRO_OS_PLUS_SEMIHOSTING_BSS char*
+      argv[MICRO_OS_PLUS_INTEGER_SEMIHOSTING_ARGV_ARRAY_SIZE];
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BOOT_PROFILER)
+  // Whatever ran since the previous mark.
+  semihosting::boot_profiler::mark ("before args");
+#endif
 
   int argc = 0;
   bool is_in_argument = false;
 
-  semihosting::param_block_t fields[2];
-  fields[0] = reinterpret_cast<semihosting::param_block_t> (cmdline);
-  fields[1] = sizeof (cmdline) - 1;
-  int ret = static_cast<int> (
-      semihosting::call_host (SEMIHOSTING_SYS_GETCMDLINE, fields));
+  int ret = static_cast<int> (semihosting::call<SEMIHOSTING_SYS_GETCMDLINE> (
+      cmdline, sizeof (cmdline) - 1));
   if (ret == 0)
     {
       // In case the host send more than we can chew, limit the
       // string to our buffer.
       cmdline[sizeof (cmdline) - 1] = '\0';
 
-      // The returned command line is a null terminated string.
-      char* p = reinterpret_cast<char*> (fields[0]);
+      // The returned command line is a null terminated string,
+      // stored in the buffer passed to the host.
+      char* p = &cmdline[0];
 
       int delim = '\0';
       int ch;
@@ -145,6 +182,28 @@ micro_os_plus_startup_initialize_args (int* p_argc, char*** p_argv)
   *p_argc = argc;
   *p_argv = &argv[0];
 
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BOOT_PROFILER)
+  semihosting::boot_profiler::mark ("args");
+#endif
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TRANSPORT_COST) \
+    && defined(MICRO_OS_PLUS_USE_SEMIHOSTING_TRANSPORT_COST_AT_STARTUP)
+  // Before the static constructors, which can then size their buffers.
+  semihosting::calibrate_transport ();
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BOOT_PROFILER)
+  semihosting::boot_profiler::mark ("transport cost");
+#endif
+#endif
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_SNAPSHOT)
+  // Before the static constructors, which can then skip the
+  // initialisations restored from the snapshot.
+  micro_os_plus_semihosting_snapshot_startup (argc, argv);
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BOOT_PROFILER)
+  semihosting::boot_profiler::mark ("snapshot");
+#endif
+#endif
+
   return;
 }
 
@@ -152,16 +211,39 @@ micro_os_plus_startup_initialize_args (int* p_argc, char*** p_argv)
 
 void __attribute__ ((noreturn, weak)) micro_os_plus_terminate (int code)
 {
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_PROFILER)
+  // If the profiler was started, save the histogram before leaving.
+  semihosting::profiler::write (
+      MICRO_OS_PLUS_STRING_SEMIHOSTING_PROFILER_FILE_NAME);
+#endif
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_METRICS)
+  // If the metrics stream was started, write the buffered samples.
+  semihosting::metrics::stop ();
+#endif
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_GCOV)
+  // Save the coverage data of all object files in a single host file.
+  semihosting::gcov::dump (MICRO_OS_PLUS_STRING_SEMIHOSTING_GCOV_FILE_NAME);
+#endif
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BOOT_PROFILER)
+  // If the application did not report the boot phases, do it now.
+  semihosting::boot_profiler::report ();
+#endif
+
+#if defined(MICRO_OS_PLUS_TRACE)
+  // Buffered trace channels must be written before leaving.
+  trace::flush ();
+#endif
+
 #if (__SIZEOF_POINTER__ == 4)
-  semihosting::call_host (SEMIHOSTING_SYS_EXIT,
-                          reinterpret_cast<semihosting::param_block_t*> (
-                              code == 0 ? ADP_STOPPED_APPLICATION_EXIT
-                                        : ADP_STOPPED_RUN_TIME_ERROR));
+  // On 32-bits only the reason is passed, the code is ignored.
+  semihosting::call<SEMIHOSTING_SYS_EXIT> (
+      code == 0 ? ADP_STOPPED_APPLICATION_EXIT : ADP_STOPPED_RUN_TIME_ERROR,
+      code);
 #elif (__SIZEOF_POINTER__ == 8)
-  semihosting::param_block_t fields[2];
-  fields[0] = ADP_STOPPED_APPLICATION_EXIT;
-  fields[1] = static_cast<semihosting::param_block_t> (code);
-  semihosting::call_host (SEMIHOSTING_SYS_EXIT, fields);
+  semihosting::call<SEMIHOSTING_SYS_EXIT> (ADP_STOPPED_APPLICATION_EXIT, code);
 #endif
 
 #if defined(MICRO_OS_PLUS_DEBUG)
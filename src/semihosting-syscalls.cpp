@@ -25,6 +25,19 @@
 #include <micro-os-plus/architecture.h>
 #include <micro-os-plus/diag/trace.h>
 
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+#include <micro-os-plus/semihosting-tmpfs.h>
+#endif
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BOOT_PROFILER)
+#include <micro-os-plus/semihosting-boot-profiler.h>
+#endif
+
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US) \
+    && defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TRANSPORT_COST)
+#include <micro-os-plus/semihosting-transport-cost.h>
+#endif
+
 #include <cstring>
 
 #include <cstdint>
@@ -32,6 +45,7 @@
 #include <cerrno>
 
 #include <sys/fcntl.h>
+#include <sys/select.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <sys/time.h>
@@ -46,10 +60,82 @@
 
 // ----------------------------------------------------------------------------
 
+// Includes the 3 standard descriptors; for minimal footprint, set it
+// to 3 plus the number of files opened at the same time.
 #if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_OPEN_FILES)
 #define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_OPEN_FILES (20)
 #endif
 
+static_assert (MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_OPEN_FILES >= 3,
+               "There must be room for stdin, stdout and stderr");
+
+// Groups of functions which can be left out when not used, for
+// example when the application provides its own definitions, or
+// to reduce the footprint:
+// - MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STAT: _stat(), _fstat()
+//   (newlib stdio calls _fstat() to size the buffers)
+// - MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_PATHS: _rename(), _unlink()
+// - MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_SYSTEM: _system()
+// - MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_TIME: _gettimeofday(),
+//   _ftime(), _clock(), _times()
+// - MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STUBS: _getpid() and
+//   the ENOSYS stubs, _execve(), _fork(), _kill(), _wait(), _link()
+//
+// MICRO_OS_PLUS_USE_SEMIHOSTING_SYSCALLS_SMALL_FOOTPRINT leaves out all
+// groups except the stat functions.
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SYSCALLS_SMALL_FOOTPRINT)
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_PATHS)
+#define MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_PATHS
+#endif
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_SYSTEM)
+#define MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_SYSTEM
+#endif
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_TIME)
+#define MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_TIME
+#endif
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STUBS)
+#define MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STUBS
+#endif
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_SYSCALLS_SMALL_FOOTPRINT)
+
+// The interval between two consecutive checks of the console
+// input readiness, while waiting in select().
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_INPUT_POLL_INTERVAL_MS)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_INPUT_POLL_INTERVAL_MS (10)
+#endif
+
+// There is no standard semihosting call to check if input is available
+// without blocking; if the host implements one as a user defined
+// operation (0x100-0x1FF), define its number here. It receives the host
+// handle and returns the number of bytes available (0 if none).
+// #define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_INPUT_READY_OPERATION (0x100)
+
+// Each host call halts the core for the entire transfer; to bound the
+// halt, define the maximum duration, in microseconds, and the large
+// _read()/_write() transfers are split in chunks, sized from the
+// measured cost per byte, or initially from the transport
+// calibration, if included.
+// #define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US (10000)
+
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US)
+
+// The chunk size used until the cost is measured.
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_INITIAL_CHUNK_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_INITIAL_CHUNK_SIZE (4096)
+#endif
+
+// The smallest chunk, to keep the host call overhead acceptable.
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MIN_CHUNK_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MIN_CHUNK_SIZE (256)
+#endif
+
+static_assert (MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MIN_CHUNK_SIZE > 0
+                   && MICRO_OS_PLUS_INTEGER_SEMIHOSTING_INITIAL_CHUNK_SIZE
+                          >= MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MIN_CHUNK_SIZE,
+               "The initial chunk must not be smaller than the minimum");
+
+#endif // defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US)
+
 // ----------------------------------------------------------------------------
 
 using namespace micro_os_plus;
@@ -83,6 +169,21 @@ extern "C"
   // it.
   void
   initialise_monitor_handles (void);
+
+  // Called repeatedly while select() waits for console input; the
+  // default does nothing, an RTOS can redefine it to sleep, so other
+  // threads can run. The timeout is measured with
+  // micro_os_plus_semihosting_clock_us().
+  void
+  micro_os_plus_semihosting_input_wait (unsigned int milliseconds);
+
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US)
+  // Called between the chunks of large transfers; the default does
+  // nothing, the application can redefine it to kick a watchdog, or
+  // an RTOS to let higher priority threads run.
+  void
+  micro_os_plus_semihosting_transfer_yield (void);
+#endif // defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US)
 }
 
 // ----------------------------------------------------------------------------
@@ -100,8 +201,25 @@ namespace
   {
     int handle;
     off_t pos;
+    // The position of the host file, which differs from `pos` after
+    // pread()/pwrite(), or one of the markers below; used to skip
+    // redundant SYS_SEEK calls.
+    off_t host_pos;
+    // The O_NONBLOCK and O_APPEND status flags.
+    int flags;
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+    // The index of the RAM file, or -1 for host files.
+    int tmpfs_index;
+#endif
   };
 
+  // The host position is not known (files in append mode, after
+  // a failed SYS_SEEK); the next positioned access must seek.
+  constexpr off_t host_pos_unknown = -1;
+
+  // The console (":tt") has no position; it is never seeked.
+  constexpr off_t host_pos_console = -2;
+
 #pragma GCC diagnostic pop
 
   /*
@@ -120,7 +238,8 @@ namespace
    *
    * Every other function must use find_slot().
    */
-  file opened_files[MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_OPEN_FILES];
+  MICRO_OS_PLUS_SEMIHOSTING_BSS file
+      opened_files[MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_OPEN_FILES];
 
   file*
   find_slot (int fd);
@@ -137,8 +256,39 @@ namespace
   int
   check_error (int result);
 
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STAT)
   int
   stat_impl (int fd, struct stat* st);
+#endif // !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STAT)
+
+  bool
+  is_input_ready (int fd, file* pfd);
+
+  int
+  seek_host (file* pfd, off_t offset);
+
+  ssize_t
+  read_at (file* pfd, off_t offset, void* buf, size_t nbyte);
+
+  ssize_t
+  write_at (file* pfd, off_t offset, const void* buf, size_t nbyte);
+
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US)
+  template <int Operation, typename Byte>
+  int
+  chunked_transfer (int handle, Byte* buf, size_t nbyte);
+#endif // defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US)
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+  // Used as host handle for RAM files, to mark the slot as used.
+  constexpr int tmpfs_handle = -2;
+
+  inline bool
+  is_tmpfs (const file* pfd)
+  {
+    return pfd->tmpfs_index >= 0;
+  }
+#endif
 } // namespace
 
 // ----------------------------------------------------------------------------
@@ -156,37 +306,22 @@ initialise_monitor_handles (void)
   // kernel can differentiate the two using the mode flag and return a
   // different descriptor for standard error.
 
-  semihosting::param_block_t fields[3];
-
-#pragma GCC diagnostic push
-
-#pragma GCC diagnostic ignored "-Wzero-as-null-pointer-constant"
-
-  fields[0] = reinterpret_cast<semihosting::param_block_t> (
-      const_cast<char*> (":tt"));
-  fields[2] = 3; // length of filename
-  fields[1] = 0; // mode "r"
-  int monitor_stdin = static_cast<int> (semihosting::call_host (
-      SEMIHOSTING_SYS_OPEN,
-      static_cast<semihosting::param_block_t*> (fields)));
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BOOT_PROFILER)
+  // The origin of the boot phases.
+  semihosting::boot_profiler::mark ("origin");
+#endif
 
-  fields[0] = reinterpret_cast<semihosting::param_block_t> (
-      const_cast<char*> (":tt"));
-  fields[2] = 3; // length of filename
-  fields[1] = 4; // mode "w"
-  int monitor_stdout = static_cast<int> (semihosting::call_host (
-      SEMIHOSTING_SYS_OPEN,
-      static_cast<semihosting::param_block_t*> (fields)));
+  int monitor_stdin
+      = static_cast<int> (semihosting::call<SEMIHOSTING_SYS_OPEN> (
+          semihosting::console_path, semihosting::open_mode::read));
 
-#pragma GCC diagnostic pop
+  int monitor_stdout
+      = static_cast<int> (semihosting::call<SEMIHOSTING_SYS_OPEN> (
+          semihosting::console_path, semihosting::open_mode::write));
 
-  fields[0] = reinterpret_cast<semihosting::param_block_t> (
-      const_cast<char*> (":tt"));
-  fields[2] = 3; // length of filename
-  fields[1] = 8; // mode "a"
-  int monitor_stderr = static_cast<int> (semihosting::call_host (
-      SEMIHOSTING_SYS_OPEN,
-      static_cast<semihosting::param_block_t*> (fields)));
+  int monitor_stderr
+      = static_cast<int> (semihosting::call<SEMIHOSTING_SYS_OPEN> (
+          semihosting::console_path, semihosting::open_mode::append));
 
   // If we failed to open stderr, redirect to stdout.
   if (monitor_stderr == -1)
@@ -197,14 +332,27 @@ initialise_monitor_handles (void)
   for (int i = 0; i < MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_OPEN_FILES; i++)
     {
       opened_files[i].handle = -1;
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+      opened_files[i].tmpfs_index = -1;
+#endif
     }
 
   opened_files[0].handle = monitor_stdin;
   opened_files[0].pos = 0;
+  opened_files[0].host_pos = host_pos_console;
+  opened_files[0].flags = 0;
   opened_files[1].handle = monitor_stdout;
   opened_files[1].pos = 0;
+  opened_files[1].host_pos = host_pos_console;
+  opened_files[1].flags = 0;
   opened_files[2].handle = monitor_stderr;
   opened_files[2].pos = 0;
+  opened_files[2].host_pos = host_pos_console;
+  opened_files[2].flags = 0;
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_BOOT_PROFILER)
+  semihosting::boot_profiler::mark ("monitor handles");
+#endif
 }
 
 // ----------------------------------------------------------------------------
@@ -264,8 +412,7 @@ namespace
   int
   get_host_errno (void)
   {
-    return static_cast<int> (
-        semihosting::call_host (SEMIHOSTING_SYS_ERRNO, nullptr));
+    return static_cast<int> (semihosting::call<SEMIHOSTING_SYS_ERRNO> ());
   }
 
   /**
@@ -292,6 +439,7 @@ namespace
     return result;
   }
 
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STAT)
   int
   stat_impl (int fd, struct stat* st)
   {
@@ -303,16 +451,23 @@ namespace
         return -1;
       }
 
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+    if (is_tmpfs (pfd))
+      {
+        st->st_mode |= S_IFREG;
+        st->st_blksize = 1024;
+        st->st_size = semihosting::tmpfs::size (pfd->tmpfs_index);
+        return 0;
+      }
+#endif
+
     // Always assume a character device, with 1024 byte blocks.
     st->st_mode |= S_IFCHR;
     st->st_blksize = 1024;
 
-    semihosting::param_block_t fields[1];
-    fields[0] = static_cast<semihosting::param_block_t> (pfd->handle);
-
     int res;
     res = check_error (static_cast<int> (
-        semihosting::call_host (SEMIHOSTING_SYS_FLEN, fields)));
+        semihosting::call<SEMIHOSTING_SYS_FLEN> (pfd->handle)));
     if (res == -1)
       {
         return -1;
@@ -322,6 +477,279 @@ namespace
     st->st_size = res;
     return 0;
   }
+#endif // !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STAT)
+
+  /**
+   * Check if a read would not block; only the console input
+   * (stdin) may block, all other files are always ready.
+   */
+  bool
+  is_input_ready (int fd, file* pfd)
+  {
+    if (fd != 0)
+      {
+        return true;
+      }
+
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_INPUT_READY_OPERATION)
+    semihosting::param_block_t fields[1];
+    fields[0] = static_cast<semihosting::param_block_t> (pfd->handle);
+    return semihosting::call_host (
+               MICRO_OS_PLUS_INTEGER_SEMIHOSTING_INPUT_READY_OPERATION,
+               fields)
+           > 0;
+#else
+    // No way to tell, assume ready; the read may block.
+    (void)pfd;
+    return true;
+#endif
+  }
+
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US)
+
+  // The measured cost of the reads and writes, in microseconds
+  // per KiB; 0 until measured. Measured only with a local clock,
+  // since with the default clock each measurement takes two more
+  // host calls; otherwise it stays at the calibrated cost, if any.
+  MICRO_OS_PLUS_SEMIHOSTING_BSS uint32_t transfer_cost[2];
+
+  size_t
+  chunk_size (uint32_t cost)
+  {
+    if (cost == 0)
+      {
+        return MICRO_OS_PLUS_INTEGER_SEMIHOSTING_INITIAL_CHUNK_SIZE;
+      }
+    uint64_t size
+        = static_cast<uint64_t> (MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US)
+          * 1024 / cost;
+    if (size < MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MIN_CHUNK_SIZE)
+      {
+        return MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MIN_CHUNK_SIZE;
+      }
+    if (size > SIZE_MAX)
+      {
+        return SIZE_MAX;
+      }
+    return static_cast<size_t> (size);
+  }
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TRANSPORT_COST)
+
+  /**
+   * The calibrated cost, in microseconds per KiB, rounded up, or 0;
+   * the reads start from the cost of the writes.
+   */
+  uint32_t
+  calibrated_cost (void)
+  {
+    auto& transport = semihosting::get_transport_cost ();
+    if (!transport.is_valid || transport.kib_ns == 0)
+      {
+        return 0;
+      }
+    return (transport.kib_ns + 999) / 1000;
+  }
+
+#endif // defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TRANSPORT_COST)
+
+  /**
+   * Transfer in chunks, each expected to halt the core at most
+   * MAX_HALT_US, and return, like the host, the number of bytes
+   * not transferred, or -1 if nothing was transferred because of
+   * an error. The transfer stops at the first short count.
+   */
+  template <int Operation, typename Byte>
+  int
+  chunked_transfer (int handle, Byte* buf, size_t nbyte)
+  {
+    uint32_t& cost
+        = transfer_cost[(Operation == SEMIHOSTING_SYS_READ) ? 0 : 1];
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TRANSPORT_COST)
+    if (cost == 0)
+      {
+        // Calibrates now, if not done before.
+        cost = calibrated_cost ();
+      }
+#endif // defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TRANSPORT_COST)
+
+    size_t chunk = chunk_size (cost);
+    if (nbyte <= chunk)
+      {
+        // A single call, not worth measuring.
+        return static_cast<int> (
+            semihosting::call<Operation> (handle, buf, nbyte));
+      }
+
+    size_t done = 0;
+    while (true)
+      {
+        size_t n = (nbyte - done < chunk) ? nbyte - done : chunk;
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_LOCAL_CLOCK)
+        uint64_t start = micro_os_plus_semihosting_clock_us ();
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_LOCAL_CLOCK)
+        int res = static_cast<int> (
+            semihosting::call<Operation> (handle, buf + done, n));
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_LOCAL_CLOCK)
+        uint64_t elapsed
+            = micro_os_plus_semihosting_clock_us () - start;
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_LOCAL_CLOCK)
+
+        if (res < 0)
+          {
+            // The error is reported by the next call.
+            return (done == 0) ? res : static_cast<int> (nbyte - done);
+          }
+        done += n - static_cast<size_t> (res);
+
+#if defined(MICRO_OS_PLUS_USE_SEMIHOSTING_LOCAL_CLOCK)
+        // Only complete chunks; a short read may include the time
+        // waiting for the console input.
+        if (res == 0 && elapsed != 0
+            && n >= MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MIN_CHUNK_SIZE)
+          {
+            uint64_t sample = elapsed * 1024 / n;
+            if (sample == 0)
+              {
+                sample = 1;
+              }
+            else if (sample > UINT32_MAX)
+              {
+                sample = UINT32_MAX;
+              }
+            // Exponential average, to smooth the variations.
+            cost = (cost == 0) ? static_cast<uint32_t> (sample)
+                               : static_cast<uint32_t> (
+                                     (3 * static_cast<uint64_t> (cost)
+                                      + sample)
+                                     / 4);
+            chunk = chunk_size (cost);
+          }
+#endif // defined(MICRO_OS_PLUS_USE_SEMIHOSTING_LOCAL_CLOCK)
+
+        if (res != 0 || done == nbyte)
+          {
+            return static_cast<int> (nbyte - done);
+          }
+
+        micro_os_plus_semihosting_transfer_yield ();
+      }
+  }
+
+#endif // defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US)
+
+  /**
+   * Move the host file position to the given offset, unless it is
+   * already there. When the host position is not known, always seek;
+   * the console is the only exception, since it has no position.
+   */
+  int
+  seek_host (file* pfd, off_t offset)
+  {
+    if (pfd->host_pos == host_pos_console || pfd->host_pos == offset)
+      {
+        return 0;
+      }
+
+    int res = check_error (
+        static_cast<int> (semihosting::call<SEMIHOSTING_SYS_SEEK> (
+            pfd->handle, static_cast<semihosting::param_block_t> (offset))));
+    if (res < 0)
+      {
+        pfd->host_pos = host_pos_unknown;
+        return -1;
+      }
+
+    pfd->host_pos = offset;
+    return 0;
+  }
+
+  /**
+   * Read from the host file at the given offset, seeking only if
+   * needed; `pfd->pos` is not changed.
+   */
+  ssize_t
+  read_at (file* pfd, off_t offset, void* buf, size_t nbyte)
+  {
+    if (seek_host (pfd, offset) != 0)
+      {
+        return -1;
+      }
+
+    int res;
+    // Returns the number of bytes *not* read.
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US)
+    res = check_error (chunked_transfer<SEMIHOSTING_SYS_READ> (
+        pfd->handle, static_cast<char*> (buf), nbyte));
+#else
+    res = check_error (static_cast<int> (
+        semihosting::call<SEMIHOSTING_SYS_READ> (pfd->handle, buf, nbyte)));
+#endif
+    if (res == -1)
+      {
+        return -1;
+      }
+
+    size_t count = nbyte - static_cast<size_t> (res);
+    if (pfd->host_pos >= 0)
+      {
+        pfd->host_pos += static_cast<off_t> (count);
+      }
+
+    // res == nbyte is not an error,
+    // at least if we want feof() to work.
+    return static_cast<ssize_t> (count);
+  }
+
+  /**
+   * Write to the host file at the given offset, seeking only if
+   * needed; `pfd->pos` is not changed. In append mode the host
+   * writes at the end of the file, whatever its position, thus
+   * the offset is ignored and there is no seek.
+   */
+  ssize_t
+  write_at (file* pfd, off_t offset, const void* buf, size_t nbyte)
+  {
+    if (!(pfd->flags & O_APPEND) && seek_host (pfd, offset) != 0)
+      {
+        return -1;
+      }
+
+    // Returns the number of bytes *not* written.
+    int res;
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US)
+    res = check_error (chunked_transfer<SEMIHOSTING_SYS_WRITE> (
+        pfd->handle, static_cast<const char*> (buf), nbyte));
+#else
+    res = check_error (static_cast<int> (
+        semihosting::call<SEMIHOSTING_SYS_WRITE> (pfd->handle, buf, nbyte)));
+#endif
+    /* Clearly an error. */
+    if (res < 0)
+      {
+        return -1;
+      }
+
+    size_t count = nbyte - static_cast<size_t> (res);
+    if (pfd->host_pos >= 0)
+      {
+        // In append mode the host wrote at the end of the file.
+        pfd->host_pos = (pfd->flags & O_APPEND)
+                            ? host_pos_unknown
+                            : pfd->host_pos + static_cast<off_t> (count);
+      }
+
+    // Did we write 0 bytes?
+    // Retrieve errno for just in case.
+    if (count == 0)
+      {
+        return with_set_errno (0);
+      }
+
+    return static_cast<ssize_t> (count);
+  }
 
 } // namespace
 
@@ -345,24 +773,46 @@ extern "C"
   off_t
   _lseek (int fildes, off_t offset, int whence);
 
+  ssize_t
+  pread (int fildes, void* buf, size_t nbyte, off_t offset);
+
+  ssize_t
+  pwrite (int fildes, const void* buf, size_t nbyte, off_t offset);
+
   int
   _isatty (int fildes);
 
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STAT)
   int
   _fstat (int fildes, struct stat* buf);
+#endif
+
+  int
+  _fcntl (int fildes, int cmd, ...);
 
+  int
+  select (int nfds, fd_set* readfds, fd_set* writefds, fd_set* errorfds,
+          timeval* timeout);
+
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STAT)
   int
   _stat (const char* path, struct stat* buf);
+#endif
 
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_PATHS)
   int
   _rename (const char* existing, const char* _new);
 
   int
   _unlink (const char* path);
+#endif
 
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_SYSTEM)
   int
   _system (const char* command);
+#endif
 
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_TIME)
   int
   _gettimeofday (timeval* ptimeval, void* ptimezone);
 
@@ -374,7 +824,9 @@ extern "C"
 
   clock_t
   _clock (void);
+#endif
 
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STUBS)
   pid_t
   _getpid (void);
 
@@ -393,6 +845,7 @@ extern "C"
 
   int
   _link (const char* existing, const char* _new);
+#endif
 }
 
 /**
@@ -418,14 +871,35 @@ _open (const char* path, int oflag, ...)
       return -1;
     }
 
-  // It is an error to open a file that already exists.
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+  // Scratch files are kept in RAM, without calling the host.
+  if (semihosting::tmpfs::is_tmpfs_path (path))
+    {
+      int index = semihosting::tmpfs::open (path, oflag);
+      if (index < 0)
+        {
+          return -1;
+        }
+      opened_files[fd].handle = tmpfs_handle;
+      opened_files[fd].pos = 0;
+      opened_files[fd].host_pos = -1;
+      opened_files[fd].flags = oflag & (O_NONBLOCK | O_APPEND);
+      opened_files[fd].tmpfs_index = index;
+      return fd;
+    }
+#endif
+
+  // It is an error to open a file that already exists; the host
+  // cannot tell, so try to open it for reading. Not via stat(), which
+  // may be excluded.
   if ((oflag & O_CREAT) && (oflag & O_EXCL))
     {
-      struct stat st;
-      int res;
-      res = stat (path, &st);
-      if (res != -1)
+      int existing
+          = static_cast<int> (semihosting::call<SEMIHOSTING_SYS_OPEN> (
+              path, semihosting::open_mode::read));
+      if (existing >= 0)
         {
+          semihosting::call<SEMIHOSTING_SYS_CLOSE> (existing);
           trace::printf ("%s() EEXIST\n", __FUNCTION__);
 
           errno = EEXIST;
@@ -461,20 +935,28 @@ _open (const char* path, int oflag, ...)
       aflags |= 8;
     }
 
-  semihosting::param_block_t fields[3];
-  fields[0] = reinterpret_cast<semihosting::param_block_t> (
-      const_cast<char*> (path));
-  fields[1] = static_cast<semihosting::param_block_t> (aflags);
-  fields[2] = std::strlen (path);
-
-  int fh = static_cast<int> (
-      semihosting::call_host (SEMIHOSTING_SYS_OPEN, fields));
+  int fh = static_cast<int> (semihosting::call<SEMIHOSTING_SYS_OPEN> (
+      path, static_cast<semihosting::open_mode> (aflags)));
 
   // Return a user file descriptor or an error.
   if (fh >= 0)
     {
       opened_files[fd].handle = fh;
       opened_files[fd].pos = 0;
+      // In append mode the writes move the host position to the end.
+      if (std::strcmp (path, semihosting::console_path.data ()) == 0)
+        {
+          opened_files[fd].host_pos = host_pos_console;
+        }
+      else
+        {
+          opened_files[fd].host_pos
+              = (oflag & O_APPEND) ? host_pos_unknown : 0;
+        }
+      opened_files[fd].flags = oflag & (O_NONBLOCK | O_APPEND);
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+      opened_files[fd].tmpfs_index = -1;
+#endif
       return fd;
     }
   else
@@ -496,6 +978,16 @@ _close (int fildes)
       return -1;
     }
 
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+  if (is_tmpfs (pfd))
+    {
+      semihosting::tmpfs::close (pfd->tmpfs_index);
+      pfd->tmpfs_index = -1;
+      pfd->handle = -1;
+      return 0;
+    }
+#endif
+
   // Handle stderr == stdout.
   if ((fildes == 1 || fildes == 2)
       && (opened_files[1].handle == opened_files[2].handle))
@@ -504,13 +996,10 @@ _close (int fildes)
       return 0;
     }
 
-  semihosting::param_block_t fields[1];
-  fields[0] = static_cast<semihosting::param_block_t> (pfd->handle);
-
   // Attempt to close the handle.
   int res;
   res = check_error (static_cast<int> (
-      semihosting::call_host (SEMIHOSTING_SYS_CLOSE, fields)));
+      semihosting::call<SEMIHOSTING_SYS_CLOSE> (pfd->handle)));
 
   // Reclaim handle?
   if (res == 0)
@@ -540,25 +1029,32 @@ _read (int fildes, void* buf, size_t nbyte)
       return -1;
     }
 
-  semihosting::param_block_t fields[3];
-  fields[0] = static_cast<semihosting::param_block_t> (pfd->handle);
-  fields[1] = reinterpret_cast<semihosting::param_block_t> (buf);
-  fields[2] = nbyte;
-
-  int res;
-  // Returns the number of bytes *not* written.
-  res = check_error (static_cast<int> (
-      semihosting::call_host (SEMIHOSTING_SYS_READ, fields)));
-  if (res == -1)
+  // Do not block in SYS_READ waiting for the console input.
+  if ((pfd->flags & O_NONBLOCK) && !is_input_ready (fildes, pfd))
     {
+      errno = EAGAIN;
       return -1;
     }
 
-  pfd->pos += static_cast<off_t> (nbyte - static_cast<size_t> (res));
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+  if (is_tmpfs (pfd))
+    {
+      ssize_t count
+          = semihosting::tmpfs::read (pfd->tmpfs_index, pfd->pos, buf, nbyte);
+      if (count > 0)
+        {
+          pfd->pos += count;
+        }
+      return count;
+    }
+#endif
 
-  // res == nbyte is not an error,
-  // at least if we want feof() to work.
-  return static_cast<ssize_t> (nbyte - static_cast<size_t> (res));
+  ssize_t count = read_at (pfd, pfd->pos, buf, nbyte);
+  if (count > 0)
+    {
+      pfd->pos += count;
+    }
+  return count;
 }
 
 ssize_t
@@ -574,32 +1070,29 @@ _write (int fildes, const void* buf, size_t nbyte)
       return -1;
     }
 
-  semihosting::param_block_t fields[3];
-
-  fields[0] = static_cast<semihosting::param_block_t> (pfd->handle);
-  fields[1] = reinterpret_cast<semihosting::param_block_t> (buf);
-  fields[2] = nbyte;
-
-  // Returns the number of bytes *not* written.
-  int res;
-  res = check_error (static_cast<int> (
-      semihosting::call_host (SEMIHOSTING_SYS_WRITE, fields)));
-  /* Clearly an error. */
-  if (res < 0)
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+  if (is_tmpfs (pfd))
     {
-      return -1;
+      if (pfd->flags & O_APPEND)
+        {
+          pfd->pos = semihosting::tmpfs::size (pfd->tmpfs_index);
+        }
+      ssize_t count = semihosting::tmpfs::write (pfd->tmpfs_index, pfd->pos,
+                                                 buf, nbyte);
+      if (count > 0)
+        {
+          pfd->pos += count;
+        }
+      return count;
     }
+#endif
 
-  pfd->pos += static_cast<off_t> (nbyte - static_cast<size_t> (res));
-
-  // Did we write 0 bytes?
-  // Retrieve errno for just in case.
-  if ((nbyte - static_cast<size_t> (res)) == 0)
+  ssize_t count = write_at (pfd, pfd->pos, buf, nbyte);
+  if (count > 0)
     {
-      return with_set_errno (0);
+      pfd->pos += count;
     }
-
-  return static_cast<ssize_t> (nbyte - static_cast<size_t> (res));
+  return count;
 }
 
 off_t
@@ -639,14 +1132,30 @@ _lseek (int fildes, off_t offset, int whence)
       whence = SEEK_SET;
     }
 
-  semihosting::param_block_t fields[2];
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+  if (is_tmpfs (pfd))
+    {
+      if (whence == SEEK_END)
+        {
+          offset += semihosting::tmpfs::size (pfd->tmpfs_index);
+        }
+      if (offset < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+      // Seeking past the end is allowed, the gap is filled on write.
+      pfd->pos = offset;
+      return offset;
+    }
+#endif
+
   int res;
 
   if (whence == SEEK_END)
     {
-      fields[0] = static_cast<semihosting::param_block_t> (pfd->handle);
       res = check_error (static_cast<int> (
-          semihosting::call_host (SEMIHOSTING_SYS_FLEN, fields)));
+          semihosting::call<SEMIHOSTING_SYS_FLEN> (pfd->handle)));
       if (res == -1)
         {
           return -1;
@@ -654,22 +1163,112 @@ _lseek (int fildes, off_t offset, int whence)
       offset += res;
     }
 
-  // This code only does absolute seeks.
-  fields[0] = static_cast<semihosting::param_block_t> (pfd->handle);
-  fields[1] = static_cast<semihosting::param_block_t> (offset);
-  res = check_error (static_cast<int> (
-      semihosting::call_host (SEMIHOSTING_SYS_SEEK, fields)));
+  // Skip the host call if the host file is already there, like
+  // for ftell(), which is lseek(fd, 0, SEEK_CUR).
+  if (offset < 0 || pfd->host_pos != offset)
+    {
+      // This code only does absolute seeks.
+      res = check_error (
+          static_cast<int> (semihosting::call<SEMIHOSTING_SYS_SEEK> (
+              pfd->handle, static_cast<semihosting::param_block_t> (offset))));
+      if (res < 0)
+        {
+          if (pfd->host_pos != host_pos_console)
+            {
+              pfd->host_pos = host_pos_unknown;
+            }
+          return -1;
+        }
+      if (pfd->host_pos != host_pos_console)
+        {
+          pfd->host_pos = offset;
+        }
+    }
 
-  // At this point ptr is the current file position.
-  if (res >= 0)
+  pfd->pos = offset;
+  return offset;
+}
+
+/**
+ * @details
+ *
+ * The `pread()` function shall be equivalent to `read()`, except that
+ * it shall read from a given position in the file without changing
+ * the file offset.
+ *
+ * The host file is seeked only if it is not already at the given
+ * offset, so consecutive records are read with a single host call each.
+ */
+ssize_t
+pread (int fildes, void* buf, size_t nbyte, off_t offset)
+{
+  file* pfd;
+  pfd = find_slot (fildes);
+  if (pfd == nullptr)
     {
-      pfd->pos = offset;
-      return offset;
+      trace::printf ("%s() EBADF\n", __FUNCTION__);
+
+      errno = EBADF;
+      return -1;
     }
-  else
+
+  if (offset < 0)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+  if (is_tmpfs (pfd))
+    {
+      return semihosting::tmpfs::read (pfd->tmpfs_index, offset, buf, nbyte);
+    }
+#endif
+
+  return read_at (pfd, offset, buf, nbyte);
+}
+
+/**
+ * @details
+ *
+ * The `pwrite()` function shall be equivalent to `write()`, except that
+ * it writes into a given position without changing the file offset.
+ *
+ * As on Linux, for files opened with `O_APPEND`, the data is
+ * appended to the end of the file, regardless of the offset.
+ */
+ssize_t
+pwrite (int fildes, const void* buf, size_t nbyte, off_t offset)
+{
+  file* pfd;
+  pfd = find_slot (fildes);
+  if (pfd == nullptr)
+    {
+      trace::printf ("%s() EBADF\n", __FUNCTION__);
+
+      errno = EBADF;
+      return -1;
+    }
+
+  if (offset < 0)
     {
+      errno = EINVAL;
       return -1;
     }
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+  if (is_tmpfs (pfd))
+    {
+      if (pfd->flags & O_APPEND)
+        {
+          offset = semihosting::tmpfs::size (pfd->tmpfs_index);
+        }
+      return semihosting::tmpfs::write (pfd->tmpfs_index, offset, buf,
+                                        nbyte);
+    }
+#endif
+
+  return write_at (pfd, offset, buf, nbyte);
 }
 
 /**
@@ -691,12 +1290,17 @@ _isatty (int fildes)
       return 0;
     }
 
-  semihosting::param_block_t fields[1];
-  fields[0] = static_cast<semihosting::param_block_t> (pfd->handle);
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+  if (is_tmpfs (pfd))
+    {
+      errno = ENOTTY;
+      return 0;
+    }
+#endif
 
   int tty;
   tty = static_cast<int> (
-      semihosting::call_host (SEMIHOSTING_SYS_ISTTY, fields));
+      semihosting::call<SEMIHOSTING_SYS_ISTTY> (pfd->handle));
 
   if (tty == 1)
     {
@@ -707,6 +1311,8 @@ _isatty (int fildes)
   return 0;
 }
 
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STAT)
+
 int
 _fstat (int fildes, struct stat* buf)
 {
@@ -714,9 +1320,213 @@ _fstat (int fildes, struct stat* buf)
   return stat_impl (fildes, buf);
 }
 
+#endif // !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STAT)
+
+/**
+ * @details
+ *
+ * Only the file status flags can be changed, and the only flag used
+ * is `O_NONBLOCK`, to prevent `read()` from blocking while waiting
+ * for the console input.
+ */
+int
+_fcntl (int fildes, int cmd, ...)
+{
+  file* pfd;
+  pfd = find_slot (fildes);
+  if (pfd == nullptr)
+    {
+      trace::printf ("%s() EBADF\n", __FUNCTION__);
+
+      errno = EBADF;
+      return -1;
+    }
+
+  switch (cmd)
+    {
+    case F_GETFL:
+      return pfd->flags;
+
+    case F_SETFL:
+      {
+        std::va_list args;
+        va_start (args, cmd);
+        int flags = va_arg (args, int);
+        va_end (args);
+
+        pfd->flags = (pfd->flags & ~O_NONBLOCK) | (flags & O_NONBLOCK);
+        return 0;
+      }
+
+    default:
+      break;
+    }
+
+#if defined(MICRO_OS_PLUS_DEBUG) \
+    && (defined(MICRO_OS_PLUS_DEBUG_SYSCALLS_BRK) \
+        || defined(MICRO_OS_PLUS_DEBUG_SYSCALL_FCNTL_BRK))
+  architecture::brk ();
+#endif
+
+  trace::printf ("%s() EINVAL\n", __FUNCTION__);
+
+  errno = EINVAL;
+  return -1;
+}
+
+/**
+ * @details
+ *
+ * All descriptors are reported ready for writing, and all except
+ * the console input (stdin) are reported ready for reading. For stdin,
+ * readiness is checked with the host, if it provides such an operation,
+ * and while waiting, `micro_os_plus_semihosting_input_wait()`
+ * is called between checks, so an RTOS can let other threads run.
+ * The timeout is measured with `micro_os_plus_semihosting_clock_us()`;
+ * only if the host has no clock, it is counted in poll intervals.
+ */
+int
+select (int nfds, fd_set* readfds, fd_set* writefds, fd_set* errorfds,
+        timeval* timeout)
+{
+  if (nfds < 0 || nfds > FD_SETSIZE)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+  // Including the descriptors beyond the table, which are never open.
+  for (int fd = 0; fd < nfds; ++fd)
+    {
+      if (((readfds != nullptr && FD_ISSET (fd, readfds))
+           || (writefds != nullptr && FD_ISSET (fd, writefds))
+           || (errorfds != nullptr && FD_ISSET (fd, errorfds)))
+          && find_slot (fd) == nullptr)
+        {
+          errno = EBADF;
+          return -1;
+        }
+    }
+
+  // Negative means wait forever.
+  long timeout_ms = -1;
+  if (timeout != nullptr)
+    {
+      timeout_ms = static_cast<long> (timeout->tv_sec) * 1000
+                   + static_cast<long> (timeout->tv_usec) / 1000;
+    }
+  // 0 if the host has no clock.
+  uint64_t start_us = (timeout_ms > 0)
+                          ? micro_os_plus_semihosting_clock_us ()
+                          : 0;
+  long remaining_ms = timeout_ms;
+
+  // Already validated, not null if waited.
+  file* pstdin = nullptr;
+  if (readfds != nullptr && nfds > 0 && FD_ISSET (0, readfds))
+    {
+      pstdin = find_slot (0);
+    }
+  bool is_stdin_waited = (pstdin != nullptr);
+  bool is_stdin_ready = false;
+
+  int count;
+  while (true)
+    {
+      if (is_stdin_waited && !is_stdin_ready)
+        {
+          is_stdin_ready = is_input_ready (0, pstdin);
+        }
+
+      count = 0;
+      for (int fd = 0; fd < nfds; ++fd)
+        {
+          if (readfds != nullptr && FD_ISSET (fd, readfds))
+            {
+              if (fd != 0 || is_stdin_ready)
+                {
+                  ++count;
+                }
+            }
+          if (writefds != nullptr && FD_ISSET (fd, writefds))
+            {
+              ++count;
+            }
+        }
+
+      if (count > 0 || !is_stdin_waited || timeout_ms == 0)
+        {
+          break;
+        }
+
+      long interval_ms
+          = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_INPUT_POLL_INTERVAL_MS;
+      if (remaining_ms > 0 && remaining_ms < interval_ms)
+        {
+          interval_ms = remaining_ms;
+        }
+
+      micro_os_plus_semihosting_input_wait (
+          static_cast<unsigned int> (interval_ms));
+
+      if (timeout_ms > 0)
+        {
+          if (start_us != 0)
+            {
+              // The real time, since the wait may return early.
+              uint64_t elapsed_ms
+                  = (micro_os_plus_semihosting_clock_us () - start_us)
+                    / 1000;
+              remaining_ms = (elapsed_ms >= static_cast<uint64_t> (timeout_ms))
+                                 ? 0
+                                 : timeout_ms - static_cast<long> (elapsed_ms);
+            }
+          else
+            {
+              remaining_ms -= interval_ms;
+            }
+          if (remaining_ms <= 0)
+            {
+              // Check once more, then give up.
+              timeout_ms = 0;
+            }
+        }
+    }
+
+  // Update the sets with the ready descriptors.
+  if (readfds != nullptr && is_stdin_waited && !is_stdin_ready)
+    {
+      FD_CLR (0, readfds);
+    }
+  if (errorfds != nullptr)
+    {
+      FD_ZERO (errorfds);
+    }
+
+  return count;
+}
+
+void __attribute__ ((weak))
+micro_os_plus_semihosting_input_wait (
+    [[maybe_unused]] unsigned int milliseconds)
+{
+  // Nothing to do; the next check is a host call anyway.
+}
+
+#if defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US)
+
+void __attribute__ ((weak))
+micro_os_plus_semihosting_transfer_yield (void)
+{
+}
+
+#endif // defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_MAX_HALT_US)
+
 // ----------------------------------------------------------------------------
 // ----- POSIX file functions -----
 
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STAT)
+
 int
 _stat (const char* path, struct stat* buf)
 {
@@ -738,19 +1548,29 @@ _stat (const char* path, struct stat* buf)
   return res;
 }
 
+#endif // !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STAT)
+
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_PATHS)
+
 int
 _rename (const char* existing, const char* _new)
 {
-  semihosting::param_block_t fields[4];
-  fields[0] = reinterpret_cast<semihosting::param_block_t> (
-      const_cast<char*> (existing));
-  fields[1] = std::strlen (existing);
-  fields[2] = reinterpret_cast<semihosting::param_block_t> (
-      const_cast<char*> (_new));
-  fields[3] = std::strlen (_new);
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+  bool is_existing_tmpfs = semihosting::tmpfs::is_tmpfs_path (existing);
+  if (is_existing_tmpfs != semihosting::tmpfs::is_tmpfs_path (_new))
+    {
+      // Files cannot be moved between the RAM and the host.
+      errno = EXDEV;
+      return -1;
+    }
+  if (is_existing_tmpfs)
+    {
+      return semihosting::tmpfs::rename (existing, _new);
+    }
+#endif
 
   return check_error (static_cast<int> (
-             semihosting::call_host (SEMIHOSTING_SYS_RENAME, fields)))
+             semihosting::call<SEMIHOSTING_SYS_RENAME> (existing, _new)))
              ? -1
              : 0;
 }
@@ -758,14 +1578,15 @@ _rename (const char* existing, const char* _new)
 int
 _unlink (const char* path)
 {
-  semihosting::param_block_t fields[2];
-  fields[0] = reinterpret_cast<semihosting::param_block_t> (
-      const_cast<char*> (path));
-  fields[1] = (strlen (path));
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+  if (semihosting::tmpfs::is_tmpfs_path (path))
+    {
+      return semihosting::tmpfs::unlink (path);
+    }
+#endif
 
   int res;
-  res = static_cast<int> (
-      semihosting::call_host (SEMIHOSTING_SYS_REMOVE, fields));
+  res = static_cast<int> (semihosting::call<SEMIHOSTING_SYS_REMOVE> (path));
   if (res == -1)
     {
       return with_set_errno (res);
@@ -773,6 +1594,10 @@ _unlink (const char* path)
   return 0;
 }
 
+#endif // !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_PATHS)
+
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_SYSTEM)
+
 int
 _system (const char* command)
 {
@@ -784,12 +1609,8 @@ _system (const char* command)
       return 1; // maybe there is a shell available? we can hope. :-P
     }
 
-  semihosting::param_block_t fields[2];
-  fields[0] = reinterpret_cast<semihosting::param_block_t> (
-      const_cast<char*> (command));
-  fields[1] = strlen (command);
-  int err = check_error (static_cast<int> (
-      semihosting::call_host (SEMIHOSTING_SYS_SYSTEM, fields)));
+  int err = check_error (
+      static_cast<int> (semihosting::call<SEMIHOSTING_SYS_SYSTEM> (command)));
   if ((err >= 0) && (err < 256))
     {
       // We have to convert e, an exit status to the encoded status of
@@ -806,15 +1627,18 @@ _system (const char* command)
   return err;
 }
 
+#endif // !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_SYSTEM)
+
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_TIME)
+
 int
 _gettimeofday (timeval* ptimeval, void* ptimezone)
 {
-  timezone* tzp = static_cast<timezone*> (ptimezone);
+  struct timezone* tzp = static_cast<struct timezone*> (ptimezone);
   if (ptimeval)
     {
       // Ask the host for the seconds since the Unix epoch.
-      ptimeval->tv_sec
-          = semihosting::call_host (SEMIHOSTING_SYS_TIME, nullptr);
+      ptimeval->tv_sec = semihosting::call<SEMIHOSTING_SYS_TIME> ();
       ptimeval->tv_usec = 0;
     }
 
@@ -832,7 +1656,7 @@ int
 _ftime (timeb* tp)
 {
   // Ask the host for the seconds since the Unix epoch.
-  tp->time = semihosting::call_host (SEMIHOSTING_SYS_TIME, nullptr);
+  tp->time = semihosting::call<SEMIHOSTING_SYS_TIME> ();
   tp->millitm = 0;
 
   return 0;
@@ -843,8 +1667,8 @@ clock_t
 _clock (void)
 {
   clock_t timeval;
-  timeval = static_cast<clock_t> (
-      semihosting::call_host (SEMIHOSTING_SYS_CLOCK, nullptr));
+  timeval
+      = static_cast<clock_t> (semihosting::call<SEMIHOSTING_SYS_CLOCK> ());
 
   return timeval;
 }
@@ -865,6 +1689,10 @@ _times (tms* buf)
   return timeval;
 }
 
+#endif // !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_TIME)
+
+#if !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STUBS)
+
 pid_t
 _getpid (void)
 {
@@ -951,6 +1779,8 @@ _link (const char* existing, const char* _new)
 
 #pragma GCC diagnostic pop
 
+#endif // !defined(MICRO_OS_PLUS_EXCLUDE_SEMIHOSTING_SYSCALLS_STUBS)
+
 // ----------------------------------------------------------------------------
 
 #if 0
@@ -0,0 +1,493 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+
+#include <micro-os-plus/semihosting.h>
+#include <micro-os-plus/semihosting-tmpfs.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+
+// ----------------------------------------------------------------------------
+
+#if !defined(MICRO_OS_PLUS_STRING_SEMIHOSTING_TMPFS_PREFIX)
+#define MICRO_OS_PLUS_STRING_SEMIHOSTING_TMPFS_PREFIX "/tmp/"
+#endif
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TMPFS_FILES_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TMPFS_FILES_ARRAY_SIZE (8)
+#endif
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TMPFS_NAME_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TMPFS_NAME_ARRAY_SIZE (32)
+#endif
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TMPFS_ARENA_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TMPFS_ARENA_ARRAY_SIZE (8192)
+#endif
+
+#if !defined(MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TMPFS_BLOCK_SIZE)
+#define MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TMPFS_BLOCK_SIZE (256)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr std::size_t files_count
+      = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TMPFS_FILES_ARRAY_SIZE;
+  constexpr std::size_t name_size
+      = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TMPFS_NAME_ARRAY_SIZE;
+  constexpr std::size_t block_size
+      = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TMPFS_BLOCK_SIZE;
+  constexpr std::size_t blocks_count
+      = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TMPFS_ARENA_ARRAY_SIZE / block_size;
+
+  static_assert (blocks_count > 0 && blocks_count < UINT16_MAX,
+                 "Invalid tmpfs arena or block size");
+
+  constexpr char prefix[] = MICRO_OS_PLUS_STRING_SEMIHOSTING_TMPFS_PREFIX;
+  constexpr std::size_t prefix_length = sizeof (prefix) - 1;
+
+  using block_index_t = std::uint16_t;
+  constexpr block_index_t no_block = UINT16_MAX;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+  struct node
+  {
+    // Empty if the file was unlinked while still open.
+    char name[name_size];
+    std::size_t size;
+    block_index_t first_block;
+    std::uint8_t open_count;
+    bool is_used;
+  };
+
+#pragma GCC diagnostic pop
+
+  MICRO_OS_PLUS_SEMIHOSTING_BSS node nodes[files_count];
+
+  // The file contents are stored in chains of fixed size blocks,
+  // linked via `next_block[]`; free blocks are in a separate chain.
+  MICRO_OS_PLUS_SEMIHOSTING_BSS std::uint8_t arena[blocks_count][block_size];
+  MICRO_OS_PLUS_SEMIHOSTING_BSS block_index_t next_block[blocks_count];
+  MICRO_OS_PLUS_SEMIHOSTING_DATA block_index_t free_blocks = no_block;
+  MICRO_OS_PLUS_SEMIHOSTING_BSS bool is_initialised;
+
+  void
+  initialise (void)
+  {
+    if (is_initialised)
+      {
+        return;
+      }
+
+    for (std::size_t i = 0; i < blocks_count; ++i)
+      {
+        next_block[i] = static_cast<block_index_t> (i + 1);
+      }
+    next_block[blocks_count - 1] = no_block;
+    free_blocks = 0;
+
+    is_initialised = true;
+  }
+
+  block_index_t
+  allocate_block (void)
+  {
+    block_index_t b = free_blocks;
+    if (b != no_block)
+      {
+        free_blocks = next_block[b];
+        next_block[b] = no_block;
+        std::memset (arena[b], 0, block_size);
+      }
+    return b;
+  }
+
+  void
+  free_chain (block_index_t b)
+  {
+    while (b != no_block)
+      {
+        block_index_t next = next_block[b];
+        next_block[b] = free_blocks;
+        free_blocks = b;
+        b = next;
+      }
+  }
+
+  void
+  remove (node& n)
+  {
+    free_chain (n.first_block);
+    n.first_block = no_block;
+    n.size = 0;
+    n.name[0] = '\0';
+    n.is_used = false;
+  }
+
+  node*
+  find (const char* path)
+  {
+    const char* name = path + prefix_length;
+    if (*name == '\0')
+      {
+        return nullptr;
+      }
+
+    for (node& n : nodes)
+      {
+        if (n.is_used && std::strcmp (n.name, name) == 0)
+          {
+            return &n;
+          }
+      }
+    return nullptr;
+  }
+
+  node*
+  get_node (int index)
+  {
+    if (index < 0 || static_cast<std::size_t> (index) >= files_count
+        || !nodes[index].is_used)
+      {
+        return nullptr;
+      }
+    return &nodes[index];
+  }
+
+  /**
+   * Return a pointer to the block storing the given position, appending
+   * blocks to the chain if needed.
+   */
+  block_index_t*
+  chain_link (node& n, std::size_t position, bool must_allocate)
+  {
+    block_index_t* link = &n.first_block;
+    for (std::size_t i = position / block_size;; --i)
+      {
+        if (*link == no_block)
+          {
+            if (!must_allocate)
+              {
+                return nullptr;
+              }
+            *link = allocate_block ();
+            if (*link == no_block)
+              {
+                return nullptr;
+              }
+          }
+        if (i == 0)
+          {
+            return link;
+          }
+        link = &next_block[*link];
+      }
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting::tmpfs
+{
+  // --------------------------------------------------------------------------
+
+  bool
+  is_tmpfs_path (const char* path) noexcept
+  {
+    return path != nullptr && std::strncmp (path, prefix, prefix_length) == 0;
+  }
+
+  int
+  open (const char* path, int oflag) noexcept
+  {
+    initialise ();
+
+    node* n = find (path);
+    if (n != nullptr)
+      {
+        if ((oflag & O_CREAT) && (oflag & O_EXCL))
+          {
+            errno = EEXIST;
+            return -1;
+          }
+        if ((oflag & O_TRUNC) && (oflag & (O_WRONLY | O_RDWR)))
+          {
+            free_chain (n->first_block);
+            n->first_block = no_block;
+            n->size = 0;
+          }
+      }
+    else
+      {
+        if (!(oflag & O_CREAT))
+          {
+            errno = ENOENT;
+            return -1;
+          }
+
+        const char* name = path + prefix_length;
+        std::size_t length = std::strlen (name);
+        if (length == 0 || length >= name_size)
+          {
+            errno = (length == 0) ? EINVAL : ENAMETOOLONG;
+            return -1;
+          }
+
+        for (node& candidate : nodes)
+          {
+            if (!candidate.is_used)
+              {
+                n = &candidate;
+                break;
+              }
+          }
+        if (n == nullptr)
+          {
+            errno = ENOSPC;
+            return -1;
+          }
+
+        std::memcpy (n->name, name, length + 1);
+        n->size = 0;
+        n->first_block = no_block;
+        n->open_count = 0;
+        n->is_used = true;
+      }
+
+    ++n->open_count;
+    return static_cast<int> (n - &nodes[0]);
+  }
+
+  int
+  close (int index) noexcept
+  {
+    node* n = get_node (index);
+    if (n == nullptr)
+      {
+        errno = EBADF;
+        return -1;
+      }
+
+    --n->open_count;
+    if (n->open_count == 0 && n->name[0] == '\0')
+      {
+        remove (*n);
+      }
+    return 0;
+  }
+
+  ssize_t
+  read (int index, off_t position, void* buf, std::size_t nbyte) noexcept
+  {
+    node* n = get_node (index);
+    if (n == nullptr || position < 0)
+      {
+        errno = (n == nullptr) ? EBADF : EINVAL;
+        return -1;
+      }
+
+    std::size_t pos = static_cast<std::size_t> (position);
+    if (pos >= n->size)
+      {
+        return 0;
+      }
+    if (nbyte > n->size - pos)
+      {
+        nbyte = n->size - pos;
+      }
+
+    block_index_t* link = chain_link (*n, pos, false);
+    if (link == nullptr)
+      {
+        return 0;
+      }
+
+    std::uint8_t* p = static_cast<std::uint8_t*> (buf);
+    block_index_t b = *link;
+    std::size_t offset = pos % block_size;
+    std::size_t remaining = nbyte;
+    while (remaining > 0)
+      {
+        std::size_t count = block_size - offset;
+        if (count > remaining)
+          {
+            count = remaining;
+          }
+        std::memcpy (p, &arena[b][offset], count);
+        p += count;
+        remaining -= count;
+        offset = 0;
+        b = next_block[b];
+      }
+
+    return static_cast<ssize_t> (nbyte);
+  }
+
+  ssize_t
+  write (int index, off_t position, const void* buf,
+         std::size_t nbyte) noexcept
+  {
+    node* n = get_node (index);
+    if (n == nullptr || position < 0)
+      {
+        errno = (n == nullptr) ? EBADF : EINVAL;
+        return -1;
+      }
+
+    if (nbyte == 0)
+      {
+        return 0;
+      }
+
+    std::size_t pos = static_cast<std::size_t> (position);
+    const std::uint8_t* p = static_cast<const std::uint8_t*> (buf);
+    std::size_t written = 0;
+
+    // New blocks are zeroed, so gaps read as zeros.
+    block_index_t* link = chain_link (*n, pos, true);
+    std::size_t offset = pos % block_size;
+    while (link != nullptr && written < nbyte)
+      {
+        std::size_t count = block_size - offset;
+        if (count > nbyte - written)
+          {
+            count = nbyte - written;
+          }
+        std::memcpy (&arena[*link][offset], p + written, count);
+        written += count;
+        offset = 0;
+
+        if (written < nbyte)
+          {
+            link = &next_block[*link];
+            if (*link == no_block)
+              {
+                *link = allocate_block ();
+                if (*link == no_block)
+                  {
+                    link = nullptr;
+                  }
+              }
+          }
+      }
+
+    if (written == 0)
+      {
+        errno = ENOSPC;
+        return -1;
+      }
+
+    if (pos + written > n->size)
+      {
+        n->size = pos + written;
+      }
+    return static_cast<ssize_t> (written);
+  }
+
+  off_t
+  size (int index) noexcept
+  {
+    node* n = get_node (index);
+    if (n == nullptr)
+      {
+        errno = EBADF;
+        return -1;
+      }
+    return static_cast<off_t> (n->size);
+  }
+
+  int
+  rename (const char* existing, const char* _new) noexcept
+  {
+    initialise ();
+
+    node* n = find (existing);
+    if (n == nullptr)
+      {
+        errno = ENOENT;
+        return -1;
+      }
+
+    const char* name = _new + prefix_length;
+    std::size_t length = std::strlen (name);
+    if (length == 0 || length >= name_size)
+      {
+        errno = (length == 0) ? EINVAL : ENAMETOOLONG;
+        return -1;
+      }
+
+    node* target = find (_new);
+    if (target == n)
+      {
+        return 0;
+      }
+    if (target != nullptr)
+      {
+        // Replace it, as POSIX requires.
+        unlink (_new);
+      }
+
+    std::memcpy (n->name, name, length + 1);
+    return 0;
+  }
+
+  int
+  unlink (const char* path) noexcept
+  {
+    initialise ();
+
+    node* n = find (path);
+    if (n == nullptr)
+      {
+        errno = ENOENT;
+        return -1;
+      }
+
+    // Keep the content while still open.
+    n->name[0] = '\0';
+    if (n->open_count == 0)
+      {
+        remove (*n);
+      }
+    return 0;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::tmpfs
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TMPFS)
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
@@ -22,7 +22,8 @@
 #if defined(MICRO_OS_PLUS_TRACE)
 
 #if defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_DEBUG) \
-    || defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_STDOUT)
+    || defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_STDOUT) \
+    || defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_FILE)
 
 #include <micro-os-plus/diag/trace.h>
 
@@ -34,6 +35,15 @@
 #endif
 
 #include <micro-os-plus/semihosting.h>
+#include <micro-os-plus/semihosting-file.h>
+#include <micro-os-plus/semihosting-trace.h>
+
+#if defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_PRINTF)
+#include <cstdarg>
+#endif
+#include <cstdint>
+#include <cstring>
+#include <span>
 
 // ----------------------------------------------------------------------------
 
@@ -51,12 +61,16 @@ namespace micro_os_plus::trace
     // For semihosting, no inits are required.
   }
 
+#if !defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_FILE)
+
   void
   flush (void)
   {
     // For semihosting, no flush is required.
   }
 
+#endif // !defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_FILE)
+
   // ----------------------------------------------------------------------------
 
   // Semihosting is another output channel that can be used for the trace
@@ -70,6 +84,10 @@ namespace micro_os_plus::trace
   // capabilities of your GDB server, and also on specific needs. It is
   // recommended to test DEBUG first, and if too slow, try STDOUT.
   //
+  // The FILE channel does not use the debugger console at all; the
+  // output is buffered and written to a host file, in large chunks,
+  // which is much faster for high volume tracing.
+  //
   // The JLink GDB server fully support semihosting, and both configurations
   // are available; to activate it, use "monitor semihosting enable" or check
   // the corresponding button in the JLink Debugging plug-in.
@@ -81,7 +99,9 @@ namespace micro_os_plus::trace
   // BKPT to communicate with the host. However, with a carefully written
   // HardFault_Handler, the semihosting BKPT calls can be processed, making
   // possible to run semihosting applications as standalone, without being
-  // terminated with hardware faults.
+  // terminated with hardware faults. To avoid a fault on each call, define
+  // MICRO_OS_PLUS_USE_SEMIHOSTING_DETACHED_MODE, and the output will be
+  // discarded after the first fault.
 
   // ----------------------------------------------------------------------------
 
@@ -106,12 +126,7 @@ namespace micro_os_plus::trace
     if (cbuf[nbyte] == '\0')
       {
         // Send string.
-        // The cast through void* is necessary to silence
-        // an alignment warning.
-        semihosting::call_host (
-            SEMIHOSTING_SYS_WRITE0,
-            reinterpret_cast<semihosting::param_block_t*> (
-                static_cast<void*> (const_cast<char*> (cbuf))));
+        semihosting::call<SEMIHOSTING_SYS_WRITE0> (cbuf);
       }
     else
       {
@@ -130,12 +145,7 @@ namespace micro_os_plus::trace
               }
             tmp[i] = '\0';
 
-            // The cast through void* is necessary to silence
-            // an alignment warning.
-            semihosting::call_host (
-                SEMIHOSTING_SYS_WRITE0,
-                reinterpret_cast<semihosting::param_block_t*> (
-                    static_cast<void*> (tmp)));
+            semihosting::call<SEMIHOSTING_SYS_WRITE0> (tmp);
 
             togo -= n;
           }
@@ -155,10 +165,8 @@ namespace micro_os_plus::trace
         return 0;
       }
 
-    static int handle; // STATIC!
+    static MICRO_OS_PLUS_SEMIHOSTING_BSS int handle; // STATIC!
 
-    // All fields should be large enough to hold a pointer.
-    semihosting::param_block_t params[3];
     semihosting::response_t ret;
 
     if (handle == 0)
@@ -166,12 +174,8 @@ namespace micro_os_plus::trace
         // On the very first call get the file handle from the host.
 
         // Special filename for stdin/out/err.
-        params[0] = reinterpret_cast<semihosting::param_block_t> (":tt");
-        params[1] = 4; // mode "w"
-        // Length of ":tt", except null terminator.
-        params[2] = sizeof (":tt") - 1;
-
-        ret = semihosting::call_host (SEMIHOSTING_SYS_OPEN, params);
+        ret = semihosting::call<SEMIHOSTING_SYS_OPEN> (
+            semihosting::console_path, semihosting::open_mode::write);
         if (ret == -1)
           {
             return -1;
@@ -180,13 +184,8 @@ namespace micro_os_plus::trace
         handle = static_cast<int> (ret);
       }
 
-    params[0] = static_cast<semihosting::param_block_t> (handle);
-    params[1] = reinterpret_cast<semihosting::param_block_t> (buf);
-    params[2] = nbyte;
     // Send character array to host file/device.
-    ret = semihosting::call_host (
-        SEMIHOSTING_SYS_WRITE,
-        static_cast<semihosting::param_block_t*> (params));
+    ret = semihosting::call<SEMIHOSTING_SYS_WRITE> (handle, buf, nbyte);
     // This call returns the number of bytes NOT written (0 if all ok).
 
     // -1 is not a legal value, but SEGGER seems to return it
@@ -205,12 +204,844 @@ namespace micro_os_plus::trace
     return static_cast<ssize_t> ((nbyte)) - ret;
   }
 
-#endif // defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_STDOUT)
+#elif defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_FILE)
+
+#if !defined(MICRO_OS_PLUS_STRING_TRACE_SEMIHOSTING_FILE_NAME)
+#define MICRO_OS_PLUS_STRING_TRACE_SEMIHOSTING_FILE_NAME "trace.log"
+#endif
+
+#if !defined(MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_FILE_BUFFER_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_FILE_BUFFER_ARRAY_SIZE (1024)
+#endif
+
+// When the file reaches this size, it is renamed with a `.1` suffix
+// (the older ones are shifted to `.2`, etc) and a new file is started;
+// 0 to never rotate.
+#if !defined(MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_FILE_ROTATE_SIZE)
+#define MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_FILE_ROTATE_SIZE \
+  (1024 * 1024)
+#endif
+
+// The number of rotated files to keep, at most 9.
+#if !defined(MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_FILE_ROTATE_COUNT)
+#define MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_FILE_ROTATE_COUNT (3)
+#endif
+
+  namespace
+  {
+    constexpr char file_name[]
+        = MICRO_OS_PLUS_STRING_TRACE_SEMIHOSTING_FILE_NAME;
+
+    constexpr std::size_t file_buffer_size
+        = MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_FILE_BUFFER_ARRAY_SIZE;
+
+    constexpr std::size_t rotate_size
+        = MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_FILE_ROTATE_SIZE;
+
+    constexpr int rotate_count
+        = MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_FILE_ROTATE_COUNT;
+
+    static_assert (rotate_count >= 1 && rotate_count <= 9,
+                   "The number of rotated files must be 1 to 9");
+
+    // The output is accumulated here, and written in large chunks.
+    MICRO_OS_PLUS_SEMIHOSTING_BSS char file_buffer[file_buffer_size];
+    MICRO_OS_PLUS_SEMIHOSTING_BSS std::size_t file_buffer_used;
+
+    // The host handle; -1 before the first write, -2 if the file
+    // cannot be created, to avoid retrying on each write.
+    MICRO_OS_PLUS_SEMIHOSTING_DATA int file_handle = -1;
+
+    // The number of bytes written to the current file.
+    MICRO_OS_PLUS_SEMIHOSTING_BSS std::size_t file_size;
+
+    // The file name followed by `.N`.
+    void
+    rotated_name (char* name, int n)
+    {
+      std::memcpy (name, file_name, sizeof (file_name) - 1);
+      name[sizeof (file_name) - 1] = '.';
+      name[sizeof (file_name)] = static_cast<char> ('0' + n);
+      name[sizeof (file_name) + 1] = '\0';
+    }
+
+    bool
+    open_file (void)
+    {
+      semihosting::response_t ret = semihosting::call<SEMIHOSTING_SYS_OPEN> (
+          file_name, semihosting::open_mode::write_binary);
+      file_handle = (ret < 0) ? -2 : static_cast<int> (ret);
+      file_size = 0;
+      return ret >= 0;
+    }
+
+    void
+    rotate_file (void)
+    {
+      semihosting::call<SEMIHOSTING_SYS_CLOSE> (file_handle);
+
+      char from[sizeof (file_name) + 2];
+      char to[sizeof (file_name) + 2];
+
+      // Drop the oldest, the rename fails on some hosts if the
+      // target exists.
+      rotated_name (to, rotate_count);
+      semihosting::call<SEMIHOSTING_SYS_REMOVE> (to);
+      for (int n = rotate_count - 1; n >= 1; --n)
+        {
+          rotated_name (from, n);
+          rotated_name (to, n + 1);
+          semihosting::call<SEMIHOSTING_SYS_RENAME> (from, to);
+        }
+      rotated_name (to, 1);
+      semihosting::call<SEMIHOSTING_SYS_RENAME> (file_name, to);
+
+      open_file ();
+    }
+
+    // Write directly to the host file, rotating if needed.
+    bool
+    write_file (const void* buf, std::size_t nbyte)
+    {
+      if (file_handle == -1)
+        {
+          open_file ();
+        }
+      else if (rotate_size != 0 && file_size >= rotate_size)
+        {
+          rotate_file ();
+        }
+
+      if (file_handle < 0)
+        {
+          return false;
+        }
+
+      // Returns the number of bytes *not* written.
+      semihosting::response_t ret
+          = semihosting::call<SEMIHOSTING_SYS_WRITE> (file_handle, buf,
+                                                      nbyte);
+      if (ret != 0)
+        {
+          return false;
+        }
+
+      file_size += nbyte;
+      return true;
+    }
+  } // namespace
+
+  /**
+   * @details
+   * The output is buffered, and reaches the host file when the
+   * buffer is full, or when `flush()` is called (also called
+   * on terminate). The callers must be serialised.
+   */
+  ssize_t
+  write (const void* buf, std::size_t nbyte)
+  {
+    if (buf == nullptr || nbyte == 0)
+      {
+        return 0;
+      }
+
+    if (file_buffer_used + nbyte > file_buffer_size)
+      {
+        flush ();
+        if (nbyte > file_buffer_size)
+          {
+            // Too large to be buffered, send as is.
+            return write_file (buf, nbyte) ? static_cast<ssize_t> (nbyte)
+                                           : -1;
+          }
+      }
+
+    std::memcpy (&file_buffer[file_buffer_used], buf, nbyte);
+    file_buffer_used += nbyte;
+
+    return static_cast<ssize_t> (nbyte);
+  }
+
+  void
+  flush (void)
+  {
+    if (file_buffer_used > 0)
+      {
+        // On error the content is lost, there is no better place
+        // to keep it.
+        write_file (file_buffer, file_buffer_used);
+        file_buffer_used = 0;
+      }
+  }
+
+#endif // defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_FILE)
+
+  // --------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_PRINTF)
+
+  // A formatter which replaces the generic `printf()`, which renders
+  // with `vsnprintf()` into an intermediate buffer. The output is
+  // rendered directly in a null terminated buffer, passed as is to the
+  // host (`SYS_WRITE0` does not need a copy in `write()` when the
+  // terminator is present). It handles only integers, characters,
+  // strings and pointers, without floating point.
+  //
+  // Each full buffer is one host call; the default holds a typical
+  // line, prefix included, at the cost of this much stack.
+
+#if !defined(MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_PRINTF_BUFFER_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_PRINTF_BUFFER_ARRAY_SIZE (128)
+#endif
+
+  namespace
+  {
+    constexpr std::size_t printf_buffer_size
+        = MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_PRINTF_BUFFER_ARRAY_SIZE;
+
+    class formatter
+    {
+    public:
+      void
+      put (char c)
+      {
+        if (length_ == sizeof (buffer_) - 1)
+          {
+            flush ();
+          }
+        buffer_[length_++] = c;
+        ++count_;
+      }
+
+      void
+      put (char c, std::size_t n)
+      {
+        for (; n > 0; --n)
+          {
+            put (c);
+          }
+      }
+
+      void
+      flush (void)
+      {
+        if (length_ > 0)
+          {
+            buffer_[length_] = '\0';
+            write (buffer_, length_);
+            length_ = 0;
+          }
+      }
+
+      int
+      count (void) const
+      {
+        return count_;
+      }
+
+    private:
+      // Allocated on the stack, for re-entrance; one more byte for
+      // the terminator.
+      char buffer_[printf_buffer_size + 1];
+      std::size_t length_ = 0;
+      int count_ = 0;
+    };
+
+    struct specification
+    {
+      std::size_t width = 0;
+      int precision = -1;
+      bool is_left = false;
+      bool is_zero_padded = false;
+      bool is_alternate = false;
+      bool is_upper = false;
+      char sign = '\0';
+    };
+
+    void
+    put_padded (formatter& out, const char* str, std::size_t length,
+                const specification& spec)
+    {
+      std::size_t pad = (spec.width > length) ? spec.width - length : 0;
+      if (!spec.is_left)
+        {
+          out.put (' ', pad);
+        }
+      for (std::size_t i = 0; i < length; ++i)
+        {
+          out.put (str[i]);
+        }
+      if (spec.is_left)
+        {
+          out.put (' ', pad);
+        }
+    }
+
+    void
+    put_integer (formatter& out, std::uintmax_t value, bool is_negative,
+                 unsigned int base, const specification& spec)
+    {
+      const char* table
+          = spec.is_upper ? "0123456789ABCDEF" : "0123456789abcdef";
+
+      // Digits in reverse order; enough for 64-bit octal.
+      char digits[22];
+      std::size_t n = 0;
+      // Before the conversion, which consumes the value.
+      bool is_zero = (value == 0);
+      if (value <= UINT32_MAX)
+        {
+          // Avoid the expensive 64-bit division when not needed.
+          std::uint32_t v = static_cast<std::uint32_t> (value);
+          do
+            {
+              digits[n++] = table[v % base];
+              v /= base;
+            }
+          while (v != 0);
+        }
+      else
+        {
+          do
+            {
+              digits[n++] = table[value % base];
+              value /= base;
+            }
+          while (value != 0);
+        }
+
+      if (spec.precision == 0 && is_zero)
+        {
+          // An explicit zero precision prints no digits for 0.
+          n = 0;
+        }
+
+      char sign = is_negative ? '-' : spec.sign;
+      const char* prefix = "";
+      if (spec.is_alternate && !is_zero)
+        {
+          if (base == 16)
+            {
+              prefix = spec.is_upper ? "0X" : "0x";
+            }
+          else if (base == 8)
+            {
+              prefix = "0";
+            }
+        }
+      std::size_t prefix_length = std::strlen (prefix);
+
+      std::size_t zeros = 0;
+      if (spec.precision > 0
+          && static_cast<std::size_t> (spec.precision) > n)
+        {
+          zeros = static_cast<std::size_t> (spec.precision) - n;
+        }
+
+      std::size_t length
+          = (sign != '\0' ? 1 : 0) + prefix_length + zeros + n;
+      std::size_t pad = (spec.width > length) ? spec.width - length : 0;
+      if (spec.is_zero_padded && !spec.is_left && spec.precision < 0)
+        {
+          zeros += pad;
+          pad = 0;
+        }
+
+      if (!spec.is_left)
+        {
+          out.put (' ', pad);
+        }
+      if (sign != '\0')
+        {
+          out.put (sign);
+        }
+      for (std::size_t i = 0; i < prefix_length; ++i)
+        {
+          out.put (prefix[i]);
+        }
+      out.put ('0', zeros);
+      while (n > 0)
+        {
+          out.put (digits[--n]);
+        }
+      if (spec.is_left)
+        {
+          out.put (' ', pad);
+        }
+    }
+  } // namespace
+
+  int
+  vprintf (const char* format, std::va_list arguments)
+  {
+    formatter out;
+
+    for (const char* p = format; *p != '\0'; ++p)
+      {
+        if (*p != '%')
+          {
+            out.put (*p);
+            continue;
+          }
+
+        const char* start = p++;
+        specification spec;
+
+        // Flags.
+        for (;; ++p)
+          {
+            if (*p == '-')
+              {
+                spec.is_left = true;
+              }
+            else if (*p == '0')
+              {
+                spec.is_zero_padded = true;
+              }
+            else if (*p == '#')
+              {
+                spec.is_alternate = true;
+              }
+            else if (*p == '+')
+              {
+                spec.sign = '+';
+              }
+            else if (*p == ' ')
+              {
+                if (spec.sign == '\0')
+                  {
+                    spec.sign = ' ';
+                  }
+              }
+            else
+              {
+                break;
+              }
+          }
+
+        // Width.
+        if (*p == '*')
+          {
+            int width = va_arg (arguments, int);
+            if (width < 0)
+              {
+                spec.is_left = true;
+                width = -width;
+              }
+            spec.width = static_cast<std::size_t> (width);
+            ++p;
+          }
+        else
+          {
+            for (; *p >= '0' && *p <= '9'; ++p)
+              {
+                spec.width = spec.width * 10
+                             + static_cast<std::size_t> (*p - '0');
+              }
+          }
+
+        // Precision.
+        if (*p == '.')
+          {
+            ++p;
+            spec.precision = 0;
+            if (*p == '*')
+              {
+                spec.precision = va_arg (arguments, int);
+                ++p;
+              }
+            else
+              {
+                for (; *p >= '0' && *p <= '9'; ++p)
+                  {
+                    spec.precision = spec.precision * 10 + (*p - '0');
+                  }
+              }
+          }
+
+        // Length modifiers, as the number of `l` and `h`.
+        int longs = 0;
+        int shorts = 0;
+        bool is_size = false;
+        bool is_long_double = false;
+        for (;; ++p)
+          {
+            if (*p == 'l')
+              {
+                ++longs;
+              }
+            else if (*p == 'z' || *p == 't' || *p == 'j')
+              {
+                is_size = (*p != 'j');
+                longs = (*p == 'j') ? 2 : longs;
+              }
+            else if (*p == 'h')
+              {
+                ++shorts;
+              }
+            else if (*p == 'L')
+              {
+                is_long_double = true;
+              }
+            else
+              {
+                break;
+              }
+          }
+
+        switch (*p)
+          {
+          case 'd':
+          case 'i':
+            {
+              std::intmax_t value;
+              if (is_size)
+                {
+                  value = va_arg (arguments, std::ptrdiff_t);
+                }
+              else if (longs >= 2)
+                {
+                  value = va_arg (arguments, long long);
+                }
+              else if (longs == 1)
+                {
+                  value = va_arg (arguments, long);
+                }
+              else
+                {
+                  value = va_arg (arguments, int);
+                  if (shorts == 1)
+                    {
+                      value = static_cast<short> (value);
+                    }
+                  else if (shorts >= 2)
+                    {
+                      value = static_cast<signed char> (value);
+                    }
+                }
+              // Negate in unsigned, to also handle the minimum value.
+              std::uintmax_t magnitude = static_cast<std::uintmax_t> (value);
+              if (value < 0)
+                {
+                  magnitude = 0 - magnitude;
+                }
+              put_integer (out, magnitude, value < 0, 10, spec);
+            }
+            break;
+
+          case 'u':
+          case 'x':
+          case 'X':
+          case 'o':
+            {
+              std::uintmax_t value;
+              if (is_size)
+                {
+                  value = va_arg (arguments, std::size_t);
+                }
+              else if (longs >= 2)
+                {
+                  value = va_arg (arguments, unsigned long long);
+                }
+              else if (longs == 1)
+                {
+                  value = va_arg (arguments, unsigned long);
+                }
+              else
+                {
+                  value = va_arg (arguments, unsigned int);
+                  if (shorts == 1)
+                    {
+                      value = static_cast<unsigned short> (value);
+                    }
+                  else if (shorts >= 2)
+                    {
+                      value = static_cast<unsigned char> (value);
+                    }
+                }
+              spec.sign = '\0';
+              spec.is_upper = (*p == 'X');
+              unsigned int base
+                  = (*p == 'u') ? 10u : ((*p == 'o') ? 8u : 16u);
+              put_integer (out, value, false, base, spec);
+            }
+            break;
+
+          case 'p':
+            spec.is_alternate = true;
+            spec.sign = '\0';
+            put_integer (out,
+                         reinterpret_cast<std::uintptr_t> (
+                             va_arg (arguments, void*)),
+                         false, 16, spec);
+            break;
+
+          case 'c':
+            {
+              char c = static_cast<char> (va_arg (arguments, int));
+              put_padded (out, &c, 1, spec);
+            }
+            break;
+
+          case 's':
+            {
+              const char* str = va_arg (arguments, const char*);
+              if (str == nullptr)
+                {
+                  str = "(null)";
+                }
+              std::size_t length = 0;
+              while (str[length] != '\0'
+                     && (spec.precision < 0
+                         || length < static_cast<std::size_t> (
+                                spec.precision)))
+                {
+                  ++length;
+                }
+              put_padded (out, str, length, spec);
+            }
+            break;
+
+          case '%':
+            out.put ('%');
+            break;
+
+          case 'e':
+          case 'E':
+          case 'f':
+          case 'F':
+          case 'g':
+          case 'G':
+          case 'a':
+          case 'A':
+            // Floating point is not formatted, the conversion is shown
+            // as it is; the argument is skipped, to keep the next ones
+            // in place.
+            if (is_long_double)
+              {
+                static_cast<void> (va_arg (arguments, long double));
+              }
+            else
+              {
+                static_cast<void> (va_arg (arguments, double));
+              }
+            for (; start <= p; ++start)
+              {
+                out.put (*start);
+              }
+            break;
+
+          default:
+            // Unsupported conversions are shown as they are; the
+            // argument cannot be skipped safely.
+            for (; start <= p && *start != '\0'; ++start)
+              {
+                out.put (*start);
+              }
+            if (*p == '\0')
+              {
+                --p;
+              }
+            break;
+          }
+      }
+
+    out.flush ();
+    return out.count ();
+  }
+
+  int
+  printf (const char* format, ...)
+  {
+    std::va_list arguments;
+    va_start (arguments, format);
+    int ret = vprintf (format, arguments);
+    va_end (arguments);
 
+    return ret;
+  }
+
+#endif // defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_PRINTF)
+
+  // --------------------------------------------------------------------------
+
+#if !defined(MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_DUMP_BUFFER_ARRAY_SIZE)
+#define MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_DUMP_BUFFER_ARRAY_SIZE (1024)
+#endif
+
+  namespace
+  {
+    constexpr std::size_t dump_buffer_size
+        = MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_DUMP_BUFFER_ARRAY_SIZE;
+
+    constexpr std::size_t dump_line_bytes = 16;
+
+    // Address, 16 hex bytes, separators, ASCII column and new line.
+    constexpr std::size_t dump_max_line_length
+        = 2 * sizeof (void*) + 2 + 3 * dump_line_bytes + 1 + 3
+          + dump_line_bytes + 2;
+
+    static_assert (dump_buffer_size >= dump_max_line_length,
+                   "The dump buffer must fit at least one line");
+
+    constexpr char hex_digits[] = "0123456789abcdef";
+
+    // Static, to keep large dumps off the stack; one more byte for
+    // the terminator, which allows write() to pass the lines as they
+    // are, without copies.
+    MICRO_OS_PLUS_SEMIHOSTING_BSS char dump_buffer[dump_buffer_size + 1];
+
+    char*
+    put_hex (char* p, std::uintmax_t value, std::size_t digits)
+    {
+      for (std::size_t i = digits; i > 0; --i)
+        {
+          *p++ = hex_digits[(value >> (4 * (i - 1))) & 0xF];
+        }
+      return p;
+    }
+
+    char*
+    put_byte (char* p, std::uint8_t byte)
+    {
+      *p++ = hex_digits[byte >> 4];
+      *p++ = hex_digits[byte & 0xF];
+      return p;
+    }
+
+    void
+    flush_dump (std::size_t used)
+    {
+      if (used > 0)
+        {
+          dump_buffer[used] = '\0';
+          write (dump_buffer, used);
+        }
+    }
+  } // namespace
+
+  void
+  dump (const void* data, std::size_t size, dump_format format)
+  {
+    const std::uint8_t* bytes = static_cast<const std::uint8_t*> (data);
+    std::size_t used = 0;
+
+    for (std::size_t offset = 0; offset < size; offset += dump_line_bytes)
+      {
+        if (used + dump_max_line_length > dump_buffer_size)
+          {
+            flush_dump (used);
+            used = 0;
+          }
+
+        const std::uint8_t* line = bytes + offset;
+        std::size_t n = size - offset;
+        if (n > dump_line_bytes)
+          {
+            n = dump_line_bytes;
+          }
+
+        char* p = &dump_buffer[used];
+        p = put_hex (p, reinterpret_cast<std::uintptr_t> (line),
+                     2 * sizeof (void*));
+        *p++ = ' ';
+
+        if (format == dump_format::words)
+          {
+            std::size_t i = 0;
+            for (; i + sizeof (std::uint32_t) <= n;
+                 i += sizeof (std::uint32_t))
+              {
+                // The region may not be aligned.
+                std::uint32_t word;
+                std::memcpy (&word, line + i, sizeof (word));
+                *p++ = ' ';
+                p = put_hex (p, word, 2 * sizeof (word));
+              }
+            // A trailing partial word is shown as bytes.
+            for (; i < n; ++i)
+              {
+                *p++ = ' ';
+                p = put_byte (p, line[i]);
+              }
+          }
+        else
+          {
+            for (std::size_t i = 0; i < dump_line_bytes; ++i)
+              {
+                if (i == dump_line_bytes / 2
+                    && (i < n || format == dump_format::hex_ascii))
+                  {
+                    *p++ = ' ';
+                  }
+                if (i < n)
+                  {
+                    *p++ = ' ';
+                    p = put_byte (p, line[i]);
+                  }
+                else if (format == dump_format::hex_ascii)
+                  {
+                    // Keep the ASCII column aligned.
+                    *p++ = ' ';
+                    *p++ = ' ';
+                    *p++ = ' ';
+                  }
+              }
+
+            if (format == dump_format::hex_ascii)
+              {
+                *p++ = ' ';
+                *p++ = ' ';
+                *p++ = '|';
+                for (std::size_t i = 0; i < n; ++i)
+                  {
+                    char c = static_cast<char> (line[i]);
+                    *p++ = (line[i] >= 0x20 && line[i] < 0x7F) ? c : '.';
+                  }
+                *p++ = '|';
+              }
+          }
+
+        *p++ = '\n';
+        used = static_cast<std::size_t> (p - dump_buffer);
+      }
+
+    flush_dump (used);
+  }
+
+  int
+  dump_binary (semihosting::host_string path, const void* data,
+               std::size_t size)
+  {
+    semihosting::file f;
+    int err = f.open (path, semihosting::open_mode::write_binary);
+    if (err != 0)
+      {
+        return err;
+      }
+
+    // A single host call, unless the host writes partially.
+    std::span<const std::byte> togo{ static_cast<const std::byte*> (data),
+                                     size };
+    while (!togo.empty ())
+      {
+        semihosting::file::result res = f.write (togo);
+        if (!res)
+          {
+            err = res.error;
+            break;
+          }
+        togo = togo.subspan (res.count);
+      }
+
+    int close_err = f.close ();
+    return (err != 0) ? err : close_err;
+  }
 } // namespace micro_os_plus::trace
 
 #endif /* defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_DEBUG) || \
-          defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_STDOUT) */
+          defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_STDOUT) || \
+          defined(MICRO_OS_PLUS_USE_TRACE_SEMIHOSTING_FILE) */
 #endif // defined(MICRO_OS_PLUS_TRACE)
 
 // ----------------------------------------------------------------------------
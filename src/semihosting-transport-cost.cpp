@@ -0,0 +1,230 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#if (!(defined(__APPLE__) || defined(__linux__) || defined(__unix__))) \
+    || defined(__DOXYGEN__)
+
+// ----------------------------------------------------------------------------
+
+#if defined(MICRO_OS_PLUS_INCLUDE_CONFIG_H)
+#include <micro-os-plus/config.h>
+#endif // MICRO_OS_PLUS_INCLUDE_CONFIG_H
+
+#if defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TRANSPORT_COST)
+
+#include <micro-os-plus/semihosting-transport-cost.h>
+
+// ----------------------------------------------------------------------------
+
+// The scratch host file written by the calibration, removed at the end.
+#if !defined(MICRO_OS_PLUS_STRING_SEMIHOSTING_TRANSPORT_FILE_NAME)
+#define MICRO_OS_PLUS_STRING_SEMIHOSTING_TRANSPORT_FILE_NAME "transport.tmp"
+#endif
+
+static_assert (
+    MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TRANSPORT_BUFFER_ARRAY_SIZE > 64,
+    "The calibration buffer must be larger than 64 bytes");
+
+static_assert (MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TRANSPORT_ROUNDS > 0,
+               "At least one calibration round is required");
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr std::size_t large_size
+      = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TRANSPORT_BUFFER_ARRAY_SIZE;
+
+  // Small enough to show the fixed cost, but not empty, since some
+  // hosts shortcut empty writes.
+  constexpr std::size_t small_size = 16;
+
+  MICRO_OS_PLUS_SEMIHOSTING_BSS semihosting::transport_cost cost;
+  MICRO_OS_PLUS_SEMIHOSTING_BSS bool is_calibrated;
+
+  /**
+   * The minimum duration of an operation, over the rounds,
+   * without the time to read the clock.
+   */
+  class minimum
+  {
+  public:
+    void
+    add (std::uint64_t start, std::uint64_t end, std::uint64_t overhead)
+    {
+      std::uint64_t elapsed = end - start;
+      elapsed = (elapsed > overhead) ? elapsed - overhead : 0;
+      if (!is_set_ || elapsed < value_)
+        {
+          value_ = elapsed;
+          is_set_ = true;
+        }
+    }
+
+    std::uint64_t
+    value (void) const
+    {
+      return value_;
+    }
+
+  protected:
+    std::uint64_t value_ = 0;
+    bool is_set_ = false;
+  };
+
+  std::uint32_t
+  saturate (std::uint64_t value)
+  {
+    return (value > UINT32_MAX) ? UINT32_MAX
+                                : static_cast<std::uint32_t> (value);
+  }
+
+  /**
+   * The package clock, scaled to nanoseconds, the unit of the costs.
+   */
+  std::uint64_t
+  clock_ns (void)
+  {
+    return micro_os_plus_semihosting_clock_us () * 1000;
+  }
+
+  /**
+   * Write the buffer, and return true if completely written.
+   */
+  bool
+  write_all (int handle, const char* buffer, std::size_t size)
+  {
+    // Returns the number of bytes *not* written.
+    return semihosting::call<SEMIHOSTING_SYS_WRITE> (handle, buffer, size)
+           == 0;
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting
+{
+  // --------------------------------------------------------------------------
+
+  const transport_cost&
+  calibrate_transport (void) noexcept
+  {
+    is_calibrated = true;
+    cost = {};
+
+    if (clock_ns () == 0)
+      {
+        // No clock.
+        return cost;
+      }
+
+    static constexpr char file_name[]
+        = MICRO_OS_PLUS_STRING_SEMIHOSTING_TRANSPORT_FILE_NAME;
+    response_t handle = call<SEMIHOSTING_SYS_OPEN> (
+        host_string{ file_name, sizeof (file_name) - 1 },
+        open_mode::write_binary);
+    if (handle < 0)
+      {
+        return cost;
+      }
+
+    // The content is not relevant, but not all zeros, in case the
+    // transport compresses.
+    char buffer[large_size];
+    for (std::size_t i = 0; i < large_size; ++i)
+      {
+        buffer[i] = static_cast<char> (i * 7 + (i >> 8));
+      }
+
+    minimum clock;
+    minimum trap;
+    minimum small;
+    minimum large;
+    bool ok = true;
+
+    for (int round = 0;
+         ok && round < MICRO_OS_PLUS_INTEGER_SEMIHOSTING_TRANSPORT_ROUNDS;
+         ++round)
+      {
+        std::uint64_t start = clock_ns ();
+        std::uint64_t end = clock_ns ();
+        clock.add (start, end, 0);
+
+        start = clock_ns ();
+        call<SEMIHOSTING_SYS_ERRNO> ();
+        end = clock_ns ();
+        trap.add (start, end, clock.value ());
+
+        start = clock_ns ();
+        ok = write_all (static_cast<int> (handle), buffer, small_size);
+        end = clock_ns ();
+        small.add (start, end, clock.value ());
+
+        start = clock_ns ();
+        ok = ok && write_all (static_cast<int> (handle), buffer, large_size);
+        end = clock_ns ();
+        large.add (start, end, clock.value ());
+      }
+
+    call<SEMIHOSTING_SYS_CLOSE> (static_cast<int> (handle));
+    call<SEMIHOSTING_SYS_REMOVE> (
+        host_string{ file_name, sizeof (file_name) - 1 });
+
+    if (!ok)
+      {
+        return cost;
+      }
+
+    // A straight line through the two write sizes.
+    std::uint64_t per_kib = 0;
+    if (large.value () > small.value ())
+      {
+        per_kib = (large.value () - small.value ()) * 1024
+                  / (large_size - small_size);
+      }
+    std::uint64_t small_data = per_kib * small_size / 1024;
+
+    cost.trap_ns = saturate (trap.value ());
+    cost.write_ns = saturate (
+        (small.value () > small_data) ? small.value () - small_data : 0);
+    cost.kib_ns = saturate (per_kib);
+    cost.is_valid = true;
+
+    return cost;
+  }
+
+  const transport_cost&
+  get_transport_cost (void) noexcept
+  {
+    if (!is_calibrated)
+      {
+        return calibrate_transport ();
+      }
+    return cost;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting
+
+// ----------------------------------------------------------------------------
+
+#endif // defined(MICRO_OS_PLUS_INCLUDE_SEMIHOSTING_TRANSPORT_COST)
+
+// ----------------------------------------------------------------------------
+
+#endif // !Unix
+
+// ----------------------------------------------------------------------------
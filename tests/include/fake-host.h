@@ -0,0 +1,102 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_SEMIHOSTING_FAKE_HOST_H_
+#define MICRO_OS_PLUS_SEMIHOSTING_FAKE_HOST_H_
+
+// ----------------------------------------------------------------------------
+
+#include <micro-os-plus/semihosting.h>
+
+#include <string>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * A semihosting host running in the test process, which executes the
+ * traps with the POSIX functions, in the current folder. The console
+ * (`:tt`) output is kept in memory, to be checked by the tests.
+ */
+namespace micro_os_plus::semihosting::fake_host
+{
+  // --------------------------------------------------------------------------
+
+  // The handles returned when opening `:tt` for reading and for writing.
+  constexpr int console_input = 1000;
+  constexpr int console_output = 1001;
+
+  /**
+   * @brief Execute an operation received by other means than a trap,
+   * like the mailbox, without counting it.
+   */
+  response_t
+  execute (int operation, param_block_t* arg);
+
+  /**
+   * @brief The handler of a user defined operation; on failure it
+   * returns -1 and stores the host errno.
+   */
+  using user_operation_t = response_t (*) (param_block_t* arg, int* error);
+
+  /**
+   * @brief Set the handler of a user defined operation (0x100-0x1FF);
+   * without one, the operation fails with `ENOSYS`.
+   */
+  void
+  user_operation (int operation, user_operation_t handler);
+
+  /**
+   * @brief The number of traps of an operation, since the last
+   * `reset()`.
+   */
+  unsigned int
+  traps (int operation);
+
+  /**
+   * @brief The number of traps of all operations, since the last
+   * `reset()`.
+   */
+  unsigned int
+  traps (void);
+
+  /**
+   * @brief The console output, since the last `reset()`.
+   */
+  std::string
+  console (void);
+
+  /**
+   * @brief Clear the counters and the console output.
+   */
+  void
+  reset (void);
+
+  /**
+   * @brief Count and report a failed check.
+   */
+  bool
+  expect (bool condition, const char* message);
+
+  /**
+   * @brief The process exit code, 1 if any check failed.
+   */
+  int
+  result (void);
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::fake_host
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_SEMIHOSTING_FAKE_HOST_H_
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,61 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_ARCHITECTURE_H_
+#define MICRO_OS_PLUS_ARCHITECTURE_H_
+
+// ----------------------------------------------------------------------------
+
+// The minimal architecture definitions needed by the semihosting
+// sources, to run the tests natively; the trap is implemented by
+// the fake host, in `src/fake-host.cpp`.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif // defined(__cplusplus)
+
+  typedef uintptr_t micro_os_plus_semihosting_param_block_t;
+  typedef intptr_t micro_os_plus_semihosting_response_t;
+
+  micro_os_plus_semihosting_response_t
+  micro_os_plus_semihosting_call_host (
+      int reason, micro_os_plus_semihosting_param_block_t* arg);
+
+#if defined(__cplusplus)
+}
+#endif // defined(__cplusplus)
+
+#if defined(__cplusplus)
+
+namespace micro_os_plus::architecture
+{
+  typedef uintptr_t register_t;
+  typedef intptr_t signed_register_t;
+
+  void
+  brk (void);
+
+  void
+  wfi (void);
+} // namespace micro_os_plus::architecture
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_ARCHITECTURE_H_
+
+// ----------------------------------------------------------------------------
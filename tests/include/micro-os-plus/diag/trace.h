@@ -0,0 +1,57 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#ifndef MICRO_OS_PLUS_DIAG_TRACE_H_
+#define MICRO_OS_PLUS_DIAG_TRACE_H_
+
+// ----------------------------------------------------------------------------
+
+// The trace functions used by the semihosting sources; the tests
+// define them in `src/fake-host.cpp`, on top of the native stdio.
+
+#if defined(__cplusplus)
+
+#include <cstdarg>
+#include <cstddef>
+#include <sys/types.h>
+
+namespace micro_os_plus::trace
+{
+  void
+  initialize (void);
+
+  ssize_t
+  write (const void* buf, std::size_t nbyte);
+
+  void
+  flush (void);
+
+  int
+  printf (const char* format, ...);
+
+  int
+  vprintf (const char* format, std::va_list arguments);
+
+  int
+  puts (const char* s);
+
+  int
+  putchar (int c);
+} // namespace micro_os_plus::trace
+
+#endif // defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#endif // MICRO_OS_PLUS_DIAG_TRACE_H_
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,375 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+#include <fake-host.h>
+#include <micro-os-plus/diag/trace.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus::semihosting;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  std::recursive_mutex mutex;
+  unsigned int counters[0x200];
+  unsigned int total;
+  std::string console_text;
+  int last_errno;
+  fake_host::user_operation_t user_operations[0x100];
+
+  // The POSIX flags of the semihosting open modes.
+  constexpr int open_flags[12] = {
+    O_RDONLY,
+    O_RDONLY,
+    O_RDWR,
+    O_RDWR,
+    O_WRONLY | O_CREAT | O_TRUNC,
+    O_WRONLY | O_CREAT | O_TRUNC,
+    O_RDWR | O_CREAT | O_TRUNC,
+    O_RDWR | O_CREAT | O_TRUNC,
+    O_WRONLY | O_CREAT | O_APPEND,
+    O_WRONLY | O_CREAT | O_APPEND,
+    O_RDWR | O_CREAT | O_APPEND,
+    O_RDWR | O_CREAT | O_APPEND,
+  };
+
+  std::string
+  host_path (param_block_t address, param_block_t length)
+  {
+    return std::string{ reinterpret_cast<const char*> (address),
+                        static_cast<std::size_t> (length) };
+  }
+
+  response_t
+  failed (void)
+  {
+    last_errno = errno;
+    return -1;
+  }
+
+  int failures;
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+extern "C" micro_os_plus_semihosting_response_t
+micro_os_plus_semihosting_call_host (
+    int reason, micro_os_plus_semihosting_param_block_t* arg)
+{
+  std::lock_guard<std::recursive_mutex> lock{ mutex };
+  ++counters[reason & 0x1FF];
+  ++total;
+  return fake_host::execute (reason, arg);
+}
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::semihosting::fake_host
+{
+  // --------------------------------------------------------------------------
+
+  response_t
+  execute (int operation, param_block_t* arg)
+  {
+    std::lock_guard<std::recursive_mutex> lock{ mutex };
+
+    switch (operation)
+      {
+      case SEMIHOSTING_SYS_OPEN:
+        {
+          std::string path = host_path (arg[0], arg[2]);
+          if (arg[1] >= 12)
+            {
+              last_errno = EINVAL;
+              return -1;
+            }
+          if (path == ":tt")
+            {
+              return (arg[1] < 4) ? console_input : console_output;
+            }
+          int fd = ::open (path.c_str (), open_flags[arg[1]], 0644);
+          return (fd < 0) ? failed () : fd;
+        }
+
+      case SEMIHOSTING_SYS_CLOSE:
+        {
+          int handle = static_cast<int> (arg[0]);
+          if (handle == console_input || handle == console_output)
+            {
+              return 0;
+            }
+          return (::close (handle) != 0) ? failed () : 0;
+        }
+
+      case SEMIHOSTING_SYS_WRITEC:
+        console_text += *reinterpret_cast<const char*> (arg);
+        return 0;
+
+      case SEMIHOSTING_SYS_WRITE0:
+        console_text += reinterpret_cast<const char*> (arg);
+        return 0;
+
+      case SEMIHOSTING_SYS_WRITE:
+        {
+          int handle = static_cast<int> (arg[0]);
+          const char* data = reinterpret_cast<const char*> (arg[1]);
+          std::size_t size = static_cast<std::size_t> (arg[2]);
+          if (handle == console_output)
+            {
+              console_text.append (data, size);
+              return 0;
+            }
+          ssize_t n = ::write (handle, data, size);
+          if (n < 0)
+            {
+              return failed ();
+            }
+          // The number of bytes not written.
+          return static_cast<response_t> (size - static_cast<size_t> (n));
+        }
+
+      case SEMIHOSTING_SYS_READ:
+        {
+          int handle = static_cast<int> (arg[0]);
+          std::size_t size = static_cast<std::size_t> (arg[2]);
+          if (handle == console_input)
+            {
+              // End of file.
+              return static_cast<response_t> (size);
+            }
+          ssize_t n = ::read (handle, reinterpret_cast<void*> (arg[1]), size);
+          if (n < 0)
+            {
+              return failed ();
+            }
+          // The number of bytes not read.
+          return static_cast<response_t> (size - static_cast<size_t> (n));
+        }
+
+      case SEMIHOSTING_SYS_SEEK:
+        return (::lseek (static_cast<int> (arg[0]),
+                         static_cast<off_t> (arg[1]), SEEK_SET)
+                < 0)
+                   ? failed ()
+                   : 0;
+
+      case SEMIHOSTING_SYS_FLEN:
+        {
+          struct stat st;
+          if (::fstat (static_cast<int> (arg[0]), &st) != 0)
+            {
+              return failed ();
+            }
+          return static_cast<response_t> (st.st_size);
+        }
+
+      case SEMIHOSTING_SYS_ISTTY:
+        return (static_cast<int> (arg[0]) == console_input
+                || static_cast<int> (arg[0]) == console_output)
+                   ? 1
+                   : 0;
+
+      case SEMIHOSTING_SYS_REMOVE:
+        return (::unlink (host_path (arg[0], arg[1]).c_str ()) != 0)
+                   ? failed ()
+                   : 0;
+
+      case SEMIHOSTING_SYS_RENAME:
+        return (::rename (host_path (arg[0], arg[1]).c_str (),
+                          host_path (arg[2], arg[3]).c_str ())
+                != 0)
+                   ? failed ()
+                   : 0;
+
+      case SEMIHOSTING_SYS_ERRNO:
+        return last_errno;
+
+      case SEMIHOSTING_SYS_CLOCK:
+        // Centiseconds.
+        return static_cast<response_t> (std::clock ()
+                                        / (CLOCKS_PER_SEC / 100));
+
+      case SEMIHOSTING_SYS_TIME:
+        return static_cast<response_t> (std::time (nullptr));
+
+      case SEMIHOSTING_SYS_TICKFREQ:
+        return 1000000;
+
+      case SEMIHOSTING_SYS_ELAPSED:
+        {
+          struct timespec ts;
+          clock_gettime (CLOCK_MONOTONIC, &ts);
+          std::uint64_t us = static_cast<std::uint64_t> (ts.tv_sec) * 1000000
+                             + static_cast<std::uint64_t> (ts.tv_nsec) / 1000;
+          std::memcpy (arg, &us, sizeof (us));
+          return 0;
+        }
+
+      default:
+        if (operation >= 0x100 && operation < 0x200
+            && user_operations[operation - 0x100] != nullptr)
+          {
+            int error = 0;
+            response_t ret = user_operations[operation - 0x100](arg, &error);
+            if (ret < 0)
+              {
+                last_errno = error;
+              }
+            return ret;
+          }
+        last_errno = ENOSYS;
+        return -1;
+      }
+  }
+
+  void
+  user_operation (int operation, user_operation_t handler)
+  {
+    std::lock_guard<std::recursive_mutex> lock{ mutex };
+    user_operations[operation - 0x100] = handler;
+  }
+
+  unsigned int
+  traps (int operation)
+  {
+    std::lock_guard<std::recursive_mutex> lock{ mutex };
+    return counters[operation & 0x1FF];
+  }
+
+  unsigned int
+  traps (void)
+  {
+    std::lock_guard<std::recursive_mutex> lock{ mutex };
+    return total;
+  }
+
+  std::string
+  console (void)
+  {
+    std::lock_guard<std::recursive_mutex> lock{ mutex };
+    return console_text;
+  }
+
+  void
+  reset (void)
+  {
+    std::lock_guard<std::recursive_mutex> lock{ mutex };
+    std::memset (counters, 0, sizeof (counters));
+    total = 0;
+    console_text.clear ();
+  }
+
+  bool
+  expect (bool condition, const char* message)
+  {
+    std::printf ("%s %s\n", condition ? "ok  " : "FAIL", message);
+    if (!condition)
+      {
+        ++failures;
+      }
+    return condition;
+  }
+
+  int
+  result (void)
+  {
+    return (failures == 0) ? 0 : 1;
+  }
+
+  // --------------------------------------------------------------------------
+} // namespace micro_os_plus::semihosting::fake_host
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::architecture
+{
+  void
+  brk (void)
+  {
+    std::abort ();
+  }
+
+  void
+  wfi (void)
+  {
+  }
+} // namespace micro_os_plus::architecture
+
+// ----------------------------------------------------------------------------
+
+namespace micro_os_plus::trace
+{
+#if !defined(MICRO_OS_PLUS_TRACE)
+
+  // Otherwise defined by the semihosting trace channels, under test.
+
+  void
+  initialize (void)
+  {
+  }
+
+  ssize_t
+  write (const void* buf, std::size_t nbyte)
+  {
+    return static_cast<ssize_t> (std::fwrite (buf, 1, nbyte, stdout));
+  }
+
+  void
+  flush (void)
+  {
+    std::fflush (stdout);
+  }
+
+  int
+  printf (const char* format, ...)
+  {
+    std::va_list arguments;
+    va_start (arguments, format);
+    int ret = std::vprintf (format, arguments);
+    va_end (arguments);
+    return ret;
+  }
+
+  int
+  vprintf (const char* format, std::va_list arguments)
+  {
+    return std::vprintf (format, arguments);
+  }
+
+#endif // !defined(MICRO_OS_PLUS_TRACE)
+
+  int
+  puts (const char* s)
+  {
+    return std::puts (s);
+  }
+
+  int
+  putchar (int c)
+  {
+    return std::putchar (c);
+  }
+} // namespace micro_os_plus::trace
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,201 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+// The batched operations, with the host side executed via the reference
+// implementation in `scripts/`. When TEST_BATCH_UNSUPPORTED_HOST is
+// defined, the host fails the batch operation like OpenOCD, without
+// `ENOSYS`.
+
+#include <fake-host.h>
+
+#include <micro-os-plus/semihosting-batch.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+extern "C"
+{
+#include <semihosting-batch-host.c>
+}
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus::semihosting;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr int batch_operation
+      = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_BATCH_OPERATION;
+
+  // When not 0, the host fails the batch operation with this error.
+  int failing_error;
+
+  int
+  read_memory (void*, uint64_t address, void* buffer, size_t size)
+  {
+    std::memcpy (buffer, reinterpret_cast<const void*> (address), size);
+    return 0;
+  }
+
+  int
+  write_memory (void*, uint64_t address, const void* buffer, size_t size)
+  {
+    std::memcpy (reinterpret_cast<void*> (address), buffer, size);
+    return 0;
+  }
+
+  int64_t
+  call (void*, int operation, const uint64_t block[3], int* error)
+  {
+    param_block_t arg[3]
+        = { static_cast<param_block_t> (block[0]),
+            static_cast<param_block_t> (block[1]),
+            static_cast<param_block_t> (block[2]) };
+    response_t ret = fake_host::execute (operation, arg);
+    if (ret < 0)
+      {
+        *error = static_cast<int> (
+            fake_host::execute (SEMIHOSTING_SYS_ERRNO, nullptr));
+      }
+    return ret;
+  }
+
+  const semihosting_batch_host host{
+    nullptr, sizeof (param_block_t), read_memory, write_memory, call,
+  };
+
+  response_t
+  execute_batch (param_block_t* arg, int* error)
+  {
+    if (failing_error != 0)
+      {
+        *error = failing_error;
+        return -1;
+      }
+    return semihosting_batch_execute (&host, arg[0], arg[1]);
+  }
+
+  /**
+   * Write a file with a batch, and check its content.
+   */
+  bool
+  write_file (const char* path, const char* content)
+  {
+    batch b;
+    std::size_t o = b.add<SEMIHOSTING_SYS_OPEN> (host_string{ path },
+                                                 open_mode::write_binary);
+    b.add<SEMIHOSTING_SYS_WRITE> (batch::result_of (o), content,
+                                  std::strlen (content));
+    b.add<SEMIHOSTING_SYS_CLOSE> (batch::result_of (o));
+    if (b.run () != 0)
+      {
+        return false;
+      }
+
+    char buffer[64];
+    std::FILE* f = std::fopen (path, "rb");
+    if (f == nullptr)
+      {
+        return false;
+      }
+    std::size_t n = std::fread (buffer, 1, sizeof (buffer), f);
+    std::fclose (f);
+    return std::string{ buffer, n } == content;
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+int
+main (void)
+{
+  using fake_host::expect;
+
+  fake_host::user_operation (batch_operation, execute_batch);
+
+#if defined(TEST_BATCH_UNSUPPORTED_HOST)
+
+  // A failure of the first batch disables it, whatever the errno.
+  failing_error = ENOTSUP;
+  fake_host::reset ();
+  expect (write_file ("batch.txt", "abc"), "the first batch is replayed");
+  expect (fake_host::traps (batch_operation) == 1
+              && fake_host::traps (SEMIHOSTING_SYS_OPEN) == 1,
+          "the batch operation is tried once");
+
+  fake_host::reset ();
+  expect (write_file ("batch.txt", "def"), "the second batch");
+  expect (fake_host::traps (batch_operation) == 0,
+          "the batch operation is not tried again");
+
+#else
+
+  fake_host::reset ();
+  expect (write_file ("batch.txt", "abc"), "a batch executed by the host");
+  expect (fake_host::traps (batch_operation) == 1
+              && fake_host::traps (SEMIHOSTING_SYS_OPEN) == 0,
+          "a single trap");
+
+  // After a success, other errors are not final.
+  failing_error = EIO;
+  fake_host::reset ();
+  expect (write_file ("batch.txt", "def"), "a failed batch is replayed");
+  expect (fake_host::traps (SEMIHOSTING_SYS_OPEN) == 1,
+          "the requests are executed one by one");
+
+  failing_error = 0;
+  fake_host::reset ();
+  expect (write_file ("batch.txt", "ghi"), "the batch after an EIO");
+  expect (fake_host::traps (batch_operation) == 1
+              && fake_host::traps (SEMIHOSTING_SYS_OPEN) == 0,
+          "the batch operation is used again after an EIO");
+
+  // ENOSYS is final.
+  failing_error = ENOSYS;
+  write_file ("batch.txt", "jkl");
+  failing_error = 0;
+  fake_host::reset ();
+  expect (write_file ("batch.txt", "mno"), "the batch after an ENOSYS");
+  expect (fake_host::traps (batch_operation) == 0,
+          "the batch operation is not used after an ENOSYS");
+
+  // The host executes only the documented operations.
+  batch::request requests[1]
+      = { { SEMIHOSTING_SYS_REMOVE,
+            { reinterpret_cast<param_block_t> ("batch.txt"), 9, 0 },
+            0,
+            0 } };
+  int64_t ret = semihosting_batch_execute (
+      &host, reinterpret_cast<uint64_t> (requests), 1);
+  expect (ret == 1, "an undocumented request is counted");
+  expect (static_cast<response_t> (requests[0].result) == -1
+              && requests[0].error == ENOSYS,
+          "an undocumented request fails with ENOSYS");
+  std::FILE* f = std::fopen ("batch.txt", "rb");
+  expect (f != nullptr, "an undocumented request is not executed");
+  if (f != nullptr)
+    {
+      std::fclose (f);
+    }
+
+#endif // defined(TEST_BATCH_UNSUPPORTED_HOST)
+
+  std::remove ("batch.txt");
+
+  return fake_host::result ();
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,191 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+// The block device, against a shadow copy of the image, with the
+// number of host calls checked for the coalesced transfers.
+
+#include <fake-host.h>
+#include <micro-os-plus/semihosting-block-device.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus::semihosting;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr const char* image_path = "block-device.img";
+  constexpr std::size_t sector_size = block_device::sector_size;
+  constexpr std::size_t image_sectors = 256;
+
+  block_device device;
+  unsigned char shadow[image_sectors][sector_size];
+  unsigned char buffer[16][sector_size];
+
+  bool
+  create_image (void)
+  {
+    for (std::size_t i = 0; i < sizeof (shadow); ++i)
+      {
+        shadow[0][i] = static_cast<unsigned char> (i * 7);
+      }
+    std::FILE* f = std::fopen (image_path, "wb");
+    if (f == nullptr)
+      {
+        return false;
+      }
+    bool ok = std::fwrite (shadow, 1, sizeof (shadow), f) == sizeof (shadow);
+    return (std::fclose (f) == 0) && ok;
+  }
+
+  bool
+  image_matches_shadow (void)
+  {
+    static unsigned char content[image_sectors][sector_size];
+    std::FILE* f = std::fopen (image_path, "rb");
+    if (f == nullptr)
+      {
+        return false;
+      }
+    bool ok = std::fread (content, 1, sizeof (content), f) == sizeof (content);
+    std::fclose (f);
+    return ok && std::memcmp (content, shadow, sizeof (content)) == 0;
+  }
+
+  /**
+   * Random reads and writes, of one or more sectors, compared with the
+   * shadow copy.
+   */
+  bool
+  random_access (unsigned int iterations)
+  {
+    std::srand (1);
+    for (unsigned int it = 0; it < iterations; ++it)
+      {
+        std::size_t sector
+            = static_cast<std::size_t> (std::rand ()) % image_sectors;
+        std::size_t count
+            = (std::rand () % 4 == 0)
+                  ? 1 + static_cast<std::size_t> (std::rand ()) % 16
+                  : 1;
+        if (sector + count > image_sectors)
+          {
+            count = image_sectors - sector;
+          }
+
+        if (std::rand () % 3 == 0)
+          {
+            for (std::size_t i = 0; i < count * sector_size; ++i)
+              {
+                buffer[0][i] = static_cast<unsigned char> (std::rand ());
+              }
+            if (device.write (sector, buffer, count) != 0)
+              {
+                return false;
+              }
+            std::memcpy (shadow[sector], buffer, count * sector_size);
+          }
+        else
+          {
+            if (device.read (sector, buffer, count) != 0
+                || std::memcmp (buffer, shadow[sector], count * sector_size)
+                       != 0)
+              {
+                return false;
+              }
+          }
+
+        if (it % 1000 == 999 && device.sync () != 0)
+          {
+            return false;
+          }
+      }
+    return true;
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+int
+main (void)
+{
+  using fake_host::expect;
+
+  if (!expect (create_image (), "the image is created"))
+    {
+      return fake_host::result ();
+    }
+
+  expect (device.open (image_path) == 0, "the image is opened");
+  expect (device.sectors () == image_sectors, "the number of sectors");
+
+  expect (random_access (20000), "random access matches the shadow");
+
+  // Out of range.
+  expect (device.read (image_sectors - 1, buffer, 2) == EINVAL,
+          "a read past the end fails");
+  expect (device.write (image_sectors, buffer, 1) == EINVAL,
+          "a write past the end fails");
+
+  // Adjacent dirty sectors are written with a single call.
+  expect (device.sync () == 0, "sync");
+  for (std::size_t i = 0; i < 4; ++i)
+    {
+      std::memset (buffer[0], static_cast<int> (0xA0 + i), sector_size);
+      device.write (100 + i, buffer, 1);
+      std::memcpy (shadow[100 + i], buffer, sector_size);
+    }
+  fake_host::reset ();
+  expect (device.sync () == 0, "sync of the adjacent sectors");
+  expect (fake_host::traps (SEMIHOSTING_SYS_WRITE) == 1,
+          "the adjacent sectors are coalesced");
+  expect (fake_host::traps (SEMIHOSTING_SYS_SEEK) <= 1,
+          "at most one seek for the coalesced write");
+
+  // Multiple sectors not in the cache are read with a single call,
+  // and a sequential read needs no seek.
+  fake_host::reset ();
+  expect (device.read (200, buffer, 8) == 0
+              && std::memcmp (buffer, shadow[200], 8 * sector_size) == 0,
+          "a multiple sector read");
+  expect (fake_host::traps (SEMIHOSTING_SYS_READ) == 1,
+          "the multiple sector read is a single call");
+  fake_host::reset ();
+  expect (device.read (208, buffer, 8) == 0
+              && std::memcmp (buffer, shadow[208], 8 * sector_size) == 0,
+          "a sequential read");
+  expect (fake_host::traps (SEMIHOSTING_SYS_SEEK) == 0,
+          "the sequential read is not seeked");
+
+  // A repeatedly used sector stays in the cache.
+  device.clear_stats ();
+  for (int i = 0; i < 100; ++i)
+    {
+      device.read (0, buffer, 1);
+    }
+  expect (device.stats ().hits >= 99, "the cache hits");
+
+  expect (device.close () == 0, "the image is closed");
+  expect (image_matches_shadow (), "the image matches the shadow");
+
+  std::remove (image_path);
+
+  return fake_host::result ();
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,235 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+// The bulk coverage dump, with a fake gcov backend which replaces
+// the GCC run time and the linker script symbols; the stream is
+// parsed back and compared with the generated records.
+
+#include <fake-host.h>
+#include <micro-os-plus/semihosting-gcov.h>
+
+extern "C"
+{
+#include <gcov.h>
+}
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus::semihosting;
+
+// ----------------------------------------------------------------------------
+
+// The fake object descriptors; the real ones are opaque.
+struct gcov_info
+{
+  const char* name;
+  std::size_t size;
+};
+
+namespace
+{
+  constexpr const char* stream_path = "gcov.stream";
+
+  // Larger than the stream buffer, to be split in several writes.
+  const std::string long_name (2000, 'n');
+
+  const gcov_info infos[] = {
+    { "a.gcda", 100 },
+    { "b.gcda", 5000 },
+    // No data, the empty record is dropped.
+    { "c.gcda", 0 },
+    // Not stored, but the following objects are.
+    { long_name.c_str (), 10 },
+    { "d.gcda", 1017 },
+  };
+
+  unsigned char
+  data_byte (const gcov_info* info, std::size_t offset)
+  {
+    return static_cast<unsigned char> (offset * 31 + info->name[0]);
+  }
+
+  std::uint32_t
+  load_length (const std::vector<unsigned char>& content, std::size_t offset)
+  {
+    return static_cast<std::uint32_t> (content[offset])
+           | static_cast<std::uint32_t> (content[offset + 1]) << 8
+           | static_cast<std::uint32_t> (content[offset + 2]) << 16
+           | static_cast<std::uint32_t> (content[offset + 3]) << 24;
+  }
+
+  std::vector<unsigned char>
+  read_file (const char* path)
+  {
+    std::vector<unsigned char> content;
+    std::FILE* f = std::fopen (path, "rb");
+    if (f != nullptr)
+      {
+        int c;
+        while ((c = std::fgetc (f)) != EOF)
+          {
+            content.push_back (static_cast<unsigned char> (c));
+          }
+        std::fclose (f);
+      }
+    return content;
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+extern "C"
+{
+  extern const struct gcov_info* const __gcov_info_start[];
+  const struct gcov_info* const __gcov_info_start[]
+      = { &infos[0], &infos[1], &infos[2], &infos[3], &infos[4] };
+
+  // Normally defined by the linker script, after the last pointer.
+  __asm__ (".globl __gcov_info_end\n"
+           ".set __gcov_info_end, __gcov_info_start + 5 * "
+#if __SIZEOF_POINTER__ == 8
+           "8"
+#else
+           "4"
+#endif
+  );
+
+  void
+  __gcov_info_to_gcda (const struct gcov_info* info,
+                       void (*filename_fn) (const char*, void*),
+                       void (*dump_fn) (const void*, unsigned, void*),
+                       void* (*allocate_fn) (unsigned, void*), void* arg)
+  {
+    (void)allocate_fn;
+    filename_fn (info->name, arg);
+
+    // In pieces of various sizes, like the real records.
+    unsigned char piece[300];
+    std::size_t offset = 0;
+    std::size_t n = 1;
+    while (offset < info->size)
+      {
+        if (n > info->size - offset)
+          {
+            n = info->size - offset;
+          }
+        for (std::size_t i = 0; i < n; ++i)
+          {
+            piece[i] = data_byte (info, offset + i);
+          }
+        dump_fn (piece, static_cast<unsigned> (n), arg);
+        offset += n;
+        n = (n * 7) % sizeof (piece) + 1;
+      }
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+int
+main (void)
+{
+  using fake_host::expect;
+
+  fake_host::reset ();
+  expect (gcov::dump (stream_path) == ENAMETOOLONG,
+          "the name too long is reported");
+
+  std::vector<unsigned char> content = read_file (stream_path);
+  if (!expect (content.size () >= 8, "the stream has a header"))
+    {
+      return fake_host::result ();
+    }
+  expect (std::memcmp (&content[0], "SHGC", 4) == 0, "the magic");
+  expect (load_length (content, 4) == 1, "the version");
+
+  // Parse the records, like `scripts/split-gcov-stream.py`.
+  std::map<std::string, std::string> files;
+  std::string current;
+  bool ok = true;
+  std::size_t empty_records = 0;
+  std::size_t p = 8;
+  while (ok && p < content.size ())
+    {
+      if (p + 5 > content.size ())
+        {
+          ok = false;
+          break;
+        }
+      unsigned char type = content[p];
+      std::size_t length = load_length (content, p + 1);
+      p += 5;
+      if (p + length > content.size ())
+        {
+          ok = false;
+          break;
+        }
+      const char* payload = reinterpret_cast<const char*> (&content[p]);
+      if (type == 'F')
+        {
+          current.assign (payload, length);
+          files[current];
+        }
+      else if (type == 'D' && !current.empty ())
+        {
+          empty_records += (length == 0) ? 1 : 0;
+          files[current].append (payload, length);
+        }
+      else
+        {
+          ok = false;
+        }
+      p += length;
+    }
+  expect (ok, "the records are well formed");
+  expect (empty_records == 0, "no empty data records");
+
+  expect (files.size () == 4, "the stored objects");
+  expect (files.count (long_name) == 0, "the long name is skipped");
+  for (const gcov_info& info : infos)
+    {
+      if (info.name == long_name)
+        {
+          continue;
+        }
+      std::string expected;
+      for (std::size_t i = 0; i < info.size; ++i)
+        {
+          expected += static_cast<char> (data_byte (&info, i));
+        }
+      std::string message = std::string{ "the data of " } + info.name;
+      expect (files[info.name] == expected, message.c_str ());
+    }
+
+  // The stream is written in full buffers, not per object.
+  std::size_t buffer_size
+      = MICRO_OS_PLUS_INTEGER_SEMIHOSTING_GCOV_BUFFER_ARRAY_SIZE;
+  expect (fake_host::traps (SEMIHOSTING_SYS_WRITE)
+              <= (content.size () + buffer_size - 1) / buffer_size + 1,
+          "the stream is written in large chunks");
+  expect (fake_host::traps (SEMIHOSTING_SYS_OPEN) == 1,
+          "a single host file is opened");
+
+  std::remove (stream_path);
+
+  return fake_host::result ();
+}
+
+// ----------------------------------------------------------------------------
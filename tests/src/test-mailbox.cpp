@@ -0,0 +1,336 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+// The mailbox transport, with a second thread playing the host, via
+// the reference implementation in `scripts/`.
+
+#include <fake-host.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include <semihosting-mailbox-host.c>
+}
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus::semihosting;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  // Instead of masking the interrupts, serialise the threads.
+  std::recursive_mutex interrupts_mutex;
+} // namespace
+
+extern "C" uintptr_t
+micro_os_plus_semihosting_interrupts_disable (void)
+{
+  interrupts_mutex.lock ();
+  return 0;
+}
+
+extern "C" void
+micro_os_plus_semihosting_interrupts_restore (uintptr_t)
+{
+  interrupts_mutex.unlock ();
+}
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  std::mutex posted_mutex;
+  // The posted output, each chunk prefixed by its handle.
+  std::string posted;
+
+  int
+  read_memory (void*, uint64_t address, void* buffer, size_t size)
+  {
+    std::atomic_thread_fence (std::memory_order_acquire);
+    std::memcpy (buffer, reinterpret_cast<const void*> (address), size);
+    return 0;
+  }
+
+  int
+  write_memory (void*, uint64_t address, const void* buffer, size_t size)
+  {
+    std::memcpy (reinterpret_cast<void*> (address), buffer, size);
+    std::atomic_thread_fence (std::memory_order_release);
+    return 0;
+  }
+
+  int64_t
+  call (void*, int operation, uint64_t parameter)
+  {
+    return fake_host::execute (operation,
+                               reinterpret_cast<param_block_t*> (parameter));
+  }
+
+  void
+  output (void*, int64_t handle, const uint8_t* data, size_t size)
+  {
+    std::lock_guard<std::mutex> lock{ posted_mutex };
+    posted += "[" + std::to_string (handle) + "]";
+    posted.append (reinterpret_cast<const char*> (data), size);
+  }
+
+  std::string
+  posted_output (void)
+  {
+    std::lock_guard<std::mutex> lock{ posted_mutex };
+    return posted;
+  }
+
+  std::string
+  read_file (const char* path)
+  {
+    std::string content;
+    std::FILE* f = std::fopen (path, "rb");
+    if (f != nullptr)
+      {
+        char buffer[64];
+        std::size_t n;
+        while ((n = std::fread (buffer, 1, sizeof (buffer), f)) > 0)
+          {
+            content.append (buffer, n);
+          }
+        std::fclose (f);
+      }
+    return content;
+  }
+
+  bool
+  file_exists (const char* path)
+  {
+    std::FILE* f = std::fopen (path, "rb");
+    if (f == nullptr)
+      {
+        return false;
+      }
+    std::fclose (f);
+    return true;
+  }
+
+  /**
+   * Play a host which attaches, but stops polling as soon as
+   * a record is in the ring.
+   */
+  std::thread
+  attach_and_leave (semihosting_mailbox_host& host)
+  {
+    semihosting_mailbox_attach (&host);
+    return std::thread{ [&host] {
+      auto& mb = micro_os_plus_semihosting_mailbox;
+      while (std::atomic_ref<uint32_t> (mb.write_offset).load ()
+             == std::atomic_ref<uint32_t> (mb.read_offset).load ())
+        {
+          std::this_thread::yield ();
+        }
+      semihosting_mailbox_detach (&host);
+    } };
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+int
+main (void)
+{
+  using fake_host::expect;
+
+  // Like `initialise_monitor_handles()`, before the host polls.
+  int stdin_handle = static_cast<int> (
+      call<SEMIHOSTING_SYS_OPEN> (console_path, open_mode::read));
+  int stdout_handle = static_cast<int> (
+      call<SEMIHOSTING_SYS_OPEN> (console_path, open_mode::write));
+  expect (fake_host::traps (SEMIHOSTING_SYS_OPEN) == 2,
+          "the console is opened via the trap");
+
+  semihosting_mailbox_host host{
+    nullptr,
+    sizeof (void*),
+    reinterpret_cast<uint64_t> (&micro_os_plus_semihosting_mailbox),
+    read_memory,
+    write_memory,
+    call,
+    output,
+  };
+  expect (semihosting_mailbox_attach (&host) == 0, "the host attaches");
+
+  std::atomic<bool> stop{ false };
+  std::thread host_thread{ [&] {
+    while (!stop.load ())
+      {
+        if (semihosting_mailbox_poll (&host) < 0)
+          {
+            break;
+          }
+      }
+  } };
+
+  fake_host::reset ();
+
+  // The standard output, opened via the trap, is posted.
+  const char line[] = "posted line\n";
+  response_t ret = call<SEMIHOSTING_SYS_WRITE> (stdout_handle, line,
+                                                 sizeof (line) - 1);
+  call<SEMIHOSTING_SYS_WRITE0> ("debug\n");
+  // Waits for the host, which processes the ring in order.
+  call<SEMIHOSTING_SYS_ERRNO> ();
+
+  std::string expected_posted
+      = "[" + std::to_string (stdout_handle) + "]posted line\n[-1]debug\n";
+  expect (ret == 0, "the posted write reports all bytes written");
+  expect (posted_output () == expected_posted,
+          "the standard output is posted");
+  expect (fake_host::console ().empty (), "nothing is executed as request");
+  expect (fake_host::traps () == 0, "no traps while the host polls");
+
+  // Regular files are requests, executed by the host.
+  int handle = static_cast<int> (call<SEMIHOSTING_SYS_OPEN> (
+      host_string{ "mailbox.txt" }, open_mode::write_binary));
+  expect (handle >= 0, "a file is opened via the mailbox");
+  ret = call<SEMIHOSTING_SYS_WRITE> (handle, "abc", 3);
+  expect (ret == 0, "a file write is executed by the host");
+  call<SEMIHOSTING_SYS_CLOSE> (handle);
+  expect (read_file ("mailbox.txt") == "abc", "the file content");
+  call<SEMIHOSTING_SYS_REMOVE> (host_string{ "mailbox.txt" });
+
+  // The input console handle is not posted.
+  expect (stdin_handle != stdout_handle, "distinct console handles");
+
+  // After closing, the handle is no longer a console.
+  call<SEMIHOSTING_SYS_CLOSE> (stdout_handle);
+  call<SEMIHOSTING_SYS_WRITE> (stdout_handle, "late\n", 5);
+  expect (posted_output () == expected_posted,
+          "a closed console handle is not posted");
+  expect (fake_host::traps () == 0, "still no traps");
+
+  // Concurrent callers are serialised, the lines are not mixed.
+  {
+    constexpr int threads_count = 4;
+    constexpr int lines_count = 50;
+    std::string before = posted_output ();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; ++t)
+      {
+        threads.emplace_back ([t] {
+          for (int i = 0; i < lines_count; ++i)
+            {
+              std::string s = "thread " + std::to_string (t) + " line "
+                              + std::to_string (i) + "\n";
+              call<SEMIHOSTING_SYS_WRITE0> (s.c_str ());
+            }
+        });
+      }
+    for (auto& th : threads)
+      {
+        th.join ();
+      }
+    call<SEMIHOSTING_SYS_ERRNO> ();
+
+    std::string lines = posted_output ().substr (before.size ());
+    std::set<std::string> seen;
+    bool intact = true;
+    std::size_t start = 0;
+    while (start < lines.size ())
+      {
+        std::size_t end = lines.find ('\n', start);
+        if (end == std::string::npos || lines.compare (start, 4, "[-1]") != 0)
+          {
+            intact = false;
+            break;
+          }
+        seen.insert (lines.substr (start + 4, end - start - 4));
+        start = end + 1;
+      }
+    expect (intact && seen.size () == threads_count * lines_count,
+            "all concurrent lines are posted whole");
+  }
+
+  semihosting_mailbox_detach (&host);
+  stop.store (true);
+  host_thread.join ();
+
+  // Without the host, the requests trap again.
+  call<SEMIHOSTING_SYS_WRITE0> ("trap\n");
+  expect (fake_host::traps (SEMIHOSTING_SYS_WRITE0) == 1,
+          "the output traps after the host detaches");
+
+  // A request lost when the host stops polling fails with EIO.
+  std::thread leaving = attach_and_leave (host);
+  fake_host::reset ();
+  handle = static_cast<int> (call<SEMIHOSTING_SYS_OPEN> (
+      host_string{ "lost.txt" }, open_mode::write_binary));
+  leaving.join ();
+  expect (handle == -1, "a lost open fails");
+  expect (call<SEMIHOSTING_SYS_ERRNO> () == EIO,
+          "a lost request is reported as EIO");
+  expect (call<SEMIHOSTING_SYS_ERRNO> () != EIO, "EIO is reported once");
+  expect (fake_host::traps (SEMIHOSTING_SYS_OPEN) == 0,
+          "a lost open is not repeated");
+
+  // A request without side effects is repeated via the trap.
+  std::FILE* f = std::fopen ("flen.txt", "wb");
+  std::fputs ("12345", f);
+  std::fclose (f);
+  handle = static_cast<int> (call<SEMIHOSTING_SYS_OPEN> (
+      host_string{ "flen.txt" }, open_mode::read_binary));
+  leaving = attach_and_leave (host);
+  fake_host::reset ();
+  ret = call<SEMIHOSTING_SYS_FLEN> (handle);
+  leaving.join ();
+  expect (ret == 5, "a lost flen is repeated");
+  expect (fake_host::traps (SEMIHOSTING_SYS_FLEN) == 1,
+          "the repeated flen traps");
+
+  // When the host polls again, the lost records are skipped and the
+  // sequences are still in step.
+  semihosting_mailbox_attach (&host);
+  stop.store (false);
+  host_thread = std::thread{ [&] {
+    while (!stop.load ())
+      {
+        if (semihosting_mailbox_poll (&host) < 0)
+          {
+            break;
+          }
+      }
+  } };
+  fake_host::reset ();
+  ret = call<SEMIHOSTING_SYS_FLEN> (handle);
+  expect (ret == 5 && fake_host::traps () == 0,
+          "the requests pass via the mailbox again");
+  expect (!file_exists ("lost.txt"), "the lost open is not executed");
+  semihosting_mailbox_detach (&host);
+  stop.store (true);
+  host_thread.join ();
+
+  call<SEMIHOSTING_SYS_CLOSE> (handle);
+  std::remove ("flen.txt");
+  std::remove ("lost.txt");
+
+  return fake_host::result ();
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,158 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+// The PC sampling profiler, with the gmon.out file parsed back and
+// checked field by field.
+
+#include <fake-host.h>
+#include <micro-os-plus/semihosting-profiler.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus::semihosting;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr const char* gmon_path = "gmon.out";
+
+  // A synthetic code range; with the default 1024 bins of 4 bytes.
+  constexpr std::uintptr_t low = 0x10000;
+  constexpr std::uintptr_t high = 0x10000 + 4000;
+  constexpr std::uint32_t frequency = 1000;
+
+  constexpr std::size_t hdr_size = 4 + 4 + 3 * 4;
+  constexpr std::size_t hist_hdr_size
+      = 2 * sizeof (std::uintptr_t) + 4 + 4 + 15 + 1;
+
+  std::vector<unsigned char>
+  read_file (const char* path)
+  {
+    std::vector<unsigned char> content;
+    std::FILE* f = std::fopen (path, "rb");
+    if (f != nullptr)
+      {
+        int c;
+        while ((c = std::fgetc (f)) != EOF)
+          {
+            content.push_back (static_cast<unsigned char> (c));
+          }
+        std::fclose (f);
+      }
+    return content;
+  }
+
+  template <typename T>
+  T
+  load (const std::vector<unsigned char>& content, std::size_t offset)
+  {
+    T value{};
+    std::memcpy (&value, &content[offset], sizeof (value));
+    return value;
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+int
+main (void)
+{
+  using fake_host::expect;
+
+  expect (profiler::write (gmon_path) == EINVAL,
+          "nothing is written before start()");
+
+  expect (profiler::start (UINTPTR_MAX - 100, UINTPTR_MAX, frequency)
+              == EINVAL,
+          "a range rounded up beyond the address space");
+  expect (profiler::start (0, UINTPTR_MAX, frequency) == EINVAL,
+          "a range as large as the address space");
+  expect (profiler::write (gmon_path) == EINVAL,
+          "nothing is written after a failed start()");
+
+  expect (profiler::start (low, high, frequency) == 0, "start()");
+
+  // Bin 0 (0x10000-0x10003), bin 10, the last bin, and outside.
+  for (int i = 0; i < 900; ++i)
+    {
+      profiler::sample (low + 1);
+    }
+  for (int i = 0; i < 100; ++i)
+    {
+      profiler::sample (low + 10 * 4 + 3);
+    }
+  profiler::sample (low + 1023 * 4);
+  profiler::sample (low - 1);
+  profiler::sample (low + 1024 * 4);
+  // Saturation.
+  for (int i = 0; i < 70000; ++i)
+    {
+      profiler::sample (low + 20 * 4);
+    }
+  expect (profiler::missed_samples () == 2, "the missed samples");
+
+  fake_host::reset ();
+  expect (profiler::write (gmon_path) == 0, "the histogram is written");
+  expect (fake_host::traps (SEMIHOSTING_SYS_WRITE) == 1,
+          "with a single write");
+
+  std::vector<unsigned char> content = read_file (gmon_path);
+  constexpr std::size_t bins_offset = hdr_size + 1 + hist_hdr_size;
+  if (!expect (content.size () == bins_offset + 1024 * 2,
+               "the file size"))
+    {
+      return fake_host::result ();
+    }
+
+  expect (std::memcmp (&content[0], "gmon", 4) == 0, "the cookie");
+  expect (load<std::int32_t> (content, 4) == 1, "the version");
+  expect (content[hdr_size] == 0, "the time histogram tag");
+
+  std::size_t p = hdr_size + 1;
+  expect (load<std::uintptr_t> (content, p) == low, "low_pc");
+  p += sizeof (std::uintptr_t);
+  expect (load<std::uintptr_t> (content, p) == low + 1024 * 4,
+          "high_pc, rounded up to the last bucket");
+  p += sizeof (std::uintptr_t);
+  expect (load<std::int32_t> (content, p) == 1024, "hist_size");
+  p += 4;
+  expect (load<std::int32_t> (content, p) == frequency, "prof_rate");
+  p += 4;
+  expect (std::strcmp (reinterpret_cast<const char*> (&content[p]),
+                       "seconds")
+              == 0,
+          "dimen");
+  p += 15;
+  expect (content[p] == 's', "dimen_abbrev");
+
+  auto bin = [&] (std::size_t index) {
+    return load<std::uint16_t> (content, bins_offset + index * 2);
+  };
+  expect (bin (0) == 900, "the first bin");
+  expect (bin (10) == 100, "a middle bin");
+  expect (bin (1023) == 1, "the last bin");
+  expect (bin (20) == UINT16_MAX, "a saturated bin");
+  expect (bin (1) == 0 && bin (11) == 0, "the empty bins");
+
+  std::remove (gmon_path);
+
+  return fake_host::result ();
+}
+
+// ----------------------------------------------------------------------------
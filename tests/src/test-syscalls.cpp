@@ -0,0 +1,177 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+// The POSIX system calls, with the number of host seeks checked for
+// the positioned and the append mode accesses, and the number of host
+// calls of the chunked transfers.
+
+#include <fake-host.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus::semihosting;
+
+// The package definitions, with the newlib names.
+extern "C"
+{
+  void
+  initialise_monitor_handles (void);
+
+  int
+  _open (const char* path, int oflag, ...);
+
+  int
+  _close (int fildes);
+
+  ssize_t
+  _read (int fildes, void* buf, size_t nbyte);
+
+  ssize_t
+  _write (int fildes, const void* buf, size_t nbyte);
+}
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr const char* file_path = "syscalls.txt";
+
+  bool
+  create_file (const char* content)
+  {
+    int fd = _open (file_path, O_WRONLY | O_CREAT | O_TRUNC);
+    if (fd < 0)
+      {
+        return false;
+      }
+    std::size_t size = std::strlen (content);
+    bool ok = _write (fd, content, size) == static_cast<ssize_t> (size);
+    return (_close (fd) == 0) && ok;
+  }
+
+  bool
+  file_matches (const char* content)
+  {
+    char buffer[100];
+    std::FILE* f = std::fopen (file_path, "rb");
+    if (f == nullptr)
+      {
+        return false;
+      }
+    std::size_t n = std::fread (buffer, 1, sizeof (buffer), f);
+    std::fclose (f);
+    return n == std::strlen (content) && std::memcmp (buffer, content, n) == 0;
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+int
+main (void)
+{
+  using fake_host::expect;
+
+  initialise_monitor_handles ();
+
+  // Sequential reads and writes do not seek.
+  expect (create_file ("0123456789"), "the file is created");
+  int fd = _open (file_path, O_RDWR);
+  char buffer[10];
+  fake_host::reset ();
+  expect (_read (fd, buffer, 2) == 2 && _read (fd, buffer + 2, 2) == 2
+              && std::memcmp (buffer, "0123", 4) == 0,
+          "sequential reads");
+  expect (fake_host::traps (SEMIHOSTING_SYS_SEEK) == 0,
+          "sequential reads do not seek");
+
+  // Positioned reads seek only when needed.
+  fake_host::reset ();
+  for (off_t offset = 0; offset < 8; offset += 2)
+    {
+      pread (fd, buffer, 2, offset);
+    }
+  expect (fake_host::traps (SEMIHOSTING_SYS_SEEK) == 1,
+          "consecutive pread() calls seek once");
+  expect (_read (fd, buffer, 2) == 2 && std::memcmp (buffer, "45", 2) == 0,
+          "read() continues at the descriptor offset");
+
+  fake_host::reset ();
+  expect (_write (fd, "ab", 2) == 2 && _write (fd, "cd", 2) == 2,
+          "writes after the read");
+  expect (fake_host::traps (SEMIHOSTING_SYS_SEEK) == 0,
+          "sequential writes do not seek");
+  expect (_close (fd) == 0, "the file is closed");
+  expect (file_matches ("012345abcd"), "the content after the writes");
+
+  // In append mode the host writes at the end, without seeks.
+  fd = _open (file_path, O_WRONLY | O_APPEND);
+  fake_host::reset ();
+  expect (_write (fd, "ef", 2) == 2 && _write (fd, "gh", 2) == 2,
+          "append writes");
+  expect (pwrite (fd, "ij", 2, 0) == 2, "an append pwrite()");
+  expect (fake_host::traps (SEMIHOSTING_SYS_WRITE) == 3,
+          "one host write per append");
+  expect (fake_host::traps (SEMIHOSTING_SYS_SEEK) == 0,
+          "append writes do not seek");
+  expect (_close (fd) == 0, "the append file is closed");
+  expect (file_matches ("012345abcdefghij"),
+          "the content after the appends");
+
+  // Reads of a file in append mode still seek, since the host
+  // position is not known after a write.
+  fd = _open (file_path, O_RDWR | O_APPEND);
+  fake_host::reset ();
+  expect (_write (fd, "kl", 2) == 2, "a write in read/write append mode");
+  expect (pread (fd, buffer, 3, 2) == 3 && std::memcmp (buffer, "234", 3) == 0,
+          "pread() after an append write");
+  expect (fake_host::traps (SEMIHOSTING_SYS_SEEK) == 1,
+          "only the read seeks");
+  expect (_close (fd) == 0, "the read/write file is closed");
+  expect (file_matches ("012345abcdefghijkl"),
+          "the content after the read/write append");
+
+  // Large transfers are split in fixed chunks, without timing them
+  // with the default clock.
+  char large[1300];
+  std::memset (large, 'x', sizeof (large));
+  fd = _open (file_path, O_WRONLY | O_TRUNC);
+  fake_host::reset ();
+  expect (_write (fd, large, sizeof (large)) == sizeof (large),
+          "a chunked write");
+  expect (fake_host::traps (SEMIHOSTING_SYS_WRITE) == 3,
+          "the write is split in chunks");
+  expect (fake_host::traps (SEMIHOSTING_SYS_ELAPSED) == 0,
+          "the chunks are not timed");
+  expect (_close (fd) == 0, "the chunked file is closed");
+
+  fd = _open (file_path, O_RDONLY);
+  fake_host::reset ();
+  expect (_read (fd, large, sizeof (large)) == sizeof (large),
+          "a chunked read");
+  expect (fake_host::traps (SEMIHOSTING_SYS_READ) == 3,
+          "the read is split in chunks");
+  expect (fake_host::traps (SEMIHOSTING_SYS_ELAPSED) == 0,
+          "the read chunks are not timed");
+  expect (_close (fd) == 0, "the chunked file is closed again");
+
+  std::remove (file_path);
+
+  return fake_host::result ();
+}
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,156 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus/)
+ * Copyright (c) 2022 Liviu Ionescu.
+ *
+ * Permission to use, copy, modify, and/or distribute this software
+ * for any purpose is hereby granted, under the terms of the MIT license.
+ *
+ * If a copy of the license was not distributed with this file, it can
+ * be obtained from https://opensource.org/licenses/MIT/.
+ */
+
+// The trace formatter, on the DEBUG channel, compared with the native
+// `vsnprintf()`; the buffer is small, to split the messages.
+
+#include <fake-host.h>
+
+#include <micro-os-plus/diag/trace.h>
+
+#include <climits>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// ----------------------------------------------------------------------------
+
+using namespace micro_os_plus::semihosting;
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  constexpr std::size_t buffer_size
+      = MICRO_OS_PLUS_INTEGER_TRACE_SEMIHOSTING_PRINTF_BUFFER_ARRAY_SIZE;
+
+  std::string
+  format_natively (const char* format, std::va_list arguments)
+  {
+    char buffer[256];
+    int n = std::vsnprintf (buffer, sizeof (buffer), format, arguments);
+    return std::string{ buffer, static_cast<std::size_t> (n) };
+  }
+
+  /**
+   * Check the output and the returned count, with the native
+   * formatter as reference.
+   */
+  void
+  check (const char* format, ...)
+  {
+    std::va_list arguments;
+    va_start (arguments, format);
+    std::va_list copy;
+    va_copy (copy, arguments);
+
+    fake_host::reset ();
+    int count = micro_os_plus::trace::vprintf (format, arguments);
+    std::string expected = format_natively (format, copy);
+    va_end (copy);
+    va_end (arguments);
+
+    std::string message = std::string{ "\"" } + format + "\"";
+    bool is_same = fake_host::console () == expected
+                   && count == static_cast<int> (expected.size ());
+    if (!fake_host::expect (is_same, message.c_str ()))
+      {
+        std::printf ("     got \"%s\" (%d), expected \"%s\"\n",
+                     fake_host::console ().c_str (), count, expected.c_str ());
+      }
+  }
+
+  /**
+   * Check the output of the conversions which differ from the native
+   * formatter.
+   */
+  template <typename... Args>
+  void
+  check_expected (const char* expected, const char* format, Args... args)
+  {
+    fake_host::reset ();
+    int count = micro_os_plus::trace::printf (format, args...);
+    std::string message = std::string{ "\"" } + format + "\"";
+    if (!fake_host::expect (fake_host::console () == expected
+                                && count == static_cast<int> (
+                                       std::string{ expected }.size ()),
+                            message.c_str ()))
+      {
+        std::printf ("     got \"%s\" (%d), expected \"%s\"\n",
+                     fake_host::console ().c_str (), count, expected);
+      }
+  }
+} // namespace
+
+// ----------------------------------------------------------------------------
+
+int
+main (void)
+{
+  using fake_host::expect;
+
+  // Flags, width and precision.
+  check ("[%d] [%5d] [%-5d] [%05d]", 42, 42, 42, -42);
+  check ("[%+d] [% d] [%+d] [% 5d]", 42, 42, -42, 7);
+  check ("[%.3d] [%8.3d] [%-8.3x] [%08.3d]", 7, -7, 0xa, 5);
+  check ("[%#x] [%#X] [%#o] [%#x] [%#o]", 255, 255, 8, 0, 0);
+  check ("[%.0d] [%.0x] [%5.0d]", 0, 0, 0);
+  check ("[%*d] [%-*d] [%*d]", 6, 1, 6, 2, -6, 3);
+  check ("[%.*d] [%.*s]", 4, 9, 3, "abcdef");
+  check ("[%10s] [%-10s] [%.2s] [%s]", "right", "left", "cut", "");
+  check ("[%c] [%3c] [%-3c] [%%]", 'a', 'b', 'c');
+
+  // Length modifiers.
+  check ("[%hhd] [%hhu] [%hd] [%hu]", 300, 300, 70000, 70000);
+  check ("[%ld] [%lu] [%lx]", LONG_MIN, ULONG_MAX, 0xdeadbeefUL);
+  check ("[%lld] [%llu] [%llX]", LLONG_MIN, ULLONG_MAX, 0x123456789abcULL);
+  check ("[%jd] [%ju]", INTMAX_MIN, UINTMAX_MAX);
+  check ("[%zu] [%zx] [%zd]", SIZE_MAX, static_cast<std::size_t> (4096),
+         static_cast<std::ptrdiff_t> (-5));
+  check ("[%td] [%lo]", static_cast<std::ptrdiff_t> (-1234567), 511UL);
+  check ("[%d] [%i] [%u]", INT_MIN, INT_MAX, UINT_MAX);
+
+  // Pointers, as `0x` and the hex digits.
+  int object;
+  check ("[%p] [%20p] [%-20p]", static_cast<void*> (&object),
+         static_cast<void*> (&object), static_cast<void*> (&object));
+
+  // Floating point is skipped, and shown as it is; the next
+  // arguments stay in place.
+  check_expected ("[%f] [42] [%.2e] [x] [%Lg] [7]", "[%f] [%d] [%.2e] [%s] "
+                  "[%Lg] [%d]", 1.5, 42, 2.5, "x", 3.5L, 7);
+
+  // The messages longer than the buffer are split, without losing
+  // characters at the boundary.
+  std::string full (buffer_size, 'a');
+  check ("%s", full.c_str ());
+  expect (fake_host::traps (SEMIHOSTING_SYS_WRITE0) == 1,
+          "a message as long as the buffer takes a single call");
+
+  std::string longer = full + "b";
+  check ("%s", longer.c_str ());
+  expect (fake_host::traps (SEMIHOSTING_SYS_WRITE0) == 2,
+          "one more character takes a second call");
+
+  check ("%s%s%s|%d", full.c_str (), full.c_str (), "tail", 12345);
+  expect (fake_host::traps (SEMIHOSTING_SYS_WRITE0) == 3,
+          "each full buffer is written");
+
+  check ("%*d", static_cast<int> (buffer_size * 2), 1);
+  expect (fake_host::traps (SEMIHOSTING_SYS_WRITE0) == 2,
+          "the padding is split too");
+
+  return fake_host::result ();
+}
+
+// ----------------------------------------------------------------------------